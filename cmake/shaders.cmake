@@ -0,0 +1,99 @@
+# Build-time shader validation and embedding
+
+if(shaders_included)
+  return()
+endif()
+set(shaders_included true)
+
+if(GLGRASS_VALIDATE_SHADERS)
+  find_program(GLSLANG_VALIDATOR glslangValidator)
+  if(NOT GLSLANG_VALIDATOR)
+    message(FATAL_ERROR "glslangValidator not found. Install it, or configure "
+                        "with -DGLGRASS_VALIDATE_SHADERS=OFF to embed the "
+                        "shaders without validating them")
+  endif()
+endif()
+
+# The permutations the app compiles besides the default one of each stage,
+# validated as well. Each entry is a set of NAME=VALUE defines separated by
+# commas. Keep in sync with the ShaderBuilder::define() calls in src/
+set(grass_debug_views "DEBUG_VIEW=1" "DEBUG_VIEW=2" "DEBUG_VIEW=3")
+set(shader_permutations_grass.tese.glsl ${grass_debug_views})
+set(shader_permutations_grass.frag.glsl ${grass_debug_views})
+set(shader_permutations_grass.comp.glsl)
+foreach(workgroup_size 32 64 128 256)
+  foreach(culling 0 1)
+    # The compute shader only ever gets the cull reason view
+    foreach(debug_view 0 3)
+      list(APPEND shader_permutations_grass.comp.glsl
+           "WORKGROUP_SIZE=${workgroup_size},CULLING=${culling},DEBUG_VIEW=${debug_view}")
+    endforeach()
+  endforeach()
+endforeach()
+
+# Validates every <data_dir>/*.<stage>.glsl with glslangValidator, in its
+# default permutation and in the ones listed above, then embeds them and
+# everything under <data_dir>/include into <target>. Invalid shaders fail the
+# build, unless GLGRASS_VALIDATE_SHADERS is off.
+function(embed_shaders target data_dir)
+  file(GLOB shader_stages CONFIGURE_DEPENDS "${data_dir}/*.glsl")
+  file(GLOB shader_includes CONFIGURE_DEPENDS "${data_dir}/include/*.glsl")
+
+  set(output_dir "${CMAKE_CURRENT_BINARY_DIR}/shaders")
+  set(stamps)
+  set(embedded_names)
+
+  foreach(stage_path ${shader_stages})
+    get_filename_component(stage_name ${stage_path} NAME)
+    string(REGEX MATCH "\\.([a-z]+)\\.glsl$" stage_match ${stage_name})
+    set(stage ${CMAKE_MATCH_1})
+
+    set(expanded "${output_dir}/${stage_name}")
+    set(stamp "${expanded}.stamp")
+    set(commands
+        COMMAND shader_embed preprocess ${data_dir} ${stage_name} ${expanded})
+    if(GLGRASS_VALIDATE_SHADERS)
+      list(APPEND commands
+           COMMAND ${GLSLANG_VALIDATOR} -S ${stage} ${expanded})
+      set(permutation_index 0)
+      foreach(permutation ${shader_permutations_${stage_name}})
+        string(REPLACE "," ";" defines "${permutation}")
+        set(permuted "${output_dir}/${stage_name}.${permutation_index}")
+        list(APPEND commands
+             COMMAND shader_embed preprocess ${data_dir} ${stage_name} ${permuted} ${defines}
+             COMMAND ${GLSLANG_VALIDATOR} -S ${stage} ${permuted})
+        math(EXPR permutation_index "${permutation_index} + 1")
+      endforeach()
+    endif()
+
+    # Touched last so that a failed validation is retried on the next build
+    add_custom_command(
+      OUTPUT ${stamp}
+      COMMAND ${CMAKE_COMMAND} -E make_directory ${output_dir}
+      ${commands}
+      COMMAND ${CMAKE_COMMAND} -E touch ${stamp}
+      DEPENDS shader_embed ${stage_path} ${shader_includes}
+      COMMENT "Validating shader ${stage_name}"
+      VERBATIM)
+
+    list(APPEND stamps ${stamp})
+    list(APPEND embedded_names ${stage_name})
+  endforeach()
+
+  foreach(include_path ${shader_includes})
+    get_filename_component(include_name ${include_path} NAME)
+    list(APPEND embedded_names "include/${include_name}")
+  endforeach()
+
+  set(generated "${CMAKE_CURRENT_BINARY_DIR}/embedded_shaders_data.cpp")
+  add_custom_command(
+    OUTPUT ${generated}
+    COMMAND shader_embed embed ${data_dir} ${generated} ${embedded_names}
+    DEPENDS shader_embed ${stamps} ${shader_stages} ${shader_includes}
+    COMMENT "Embedding shaders"
+    VERBATIM)
+
+  target_sources(${target} PRIVATE ${generated})
+  target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_SOURCE_DIR})
+  target_compile_definitions(${target} PRIVATE GLGRASS_EMBED_SHADERS)
+endfunction()
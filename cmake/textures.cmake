@@ -0,0 +1,42 @@
+# Offline texture compression
+
+if(textures_included)
+  return()
+endif()
+set(textures_included true)
+
+# Compresses each listed image under <data_dir> into a BC1 KTX2 file with a
+# full mip chain. The file keeps the relative path of its image with a .ktx2
+# extension, and is written to <output_dir> and next to the app, where the
+# texture loader picks it over the image. TEXTURES are 2D textures, stored
+# bottom row first; CUBE_FACES are stored top row first. Sets <out_var> to the
+# files written to <output_dir>.
+function(compress_textures out_var data_dir output_dir)
+  cmake_parse_arguments(PARSE_ARGV 3 arg "" "" "TEXTURES;CUBE_FACES")
+
+  set(outputs)
+  foreach(image ${arg_TEXTURES} ${arg_CUBE_FACES})
+    set(flags)
+    if(image IN_LIST arg_TEXTURES)
+      set(flags --flip)
+    endif()
+
+    string(REGEX REPLACE "\\.[^./]+$" ".ktx2" compressed ${image})
+    set(output "${output_dir}/${compressed}")
+    set(loose "${CMAKE_RUNTIME_OUTPUT_DIRECTORY}/${compressed}")
+    get_filename_component(output_parent ${output} DIRECTORY)
+    get_filename_component(loose_parent ${loose} DIRECTORY)
+
+    add_custom_command(
+      OUTPUT ${output}
+      COMMAND ${CMAKE_COMMAND} -E make_directory ${output_parent} ${loose_parent}
+      COMMAND compress_texture ${flags} "${data_dir}/${image}" ${output}
+      COMMAND ${CMAKE_COMMAND} -E copy ${output} ${loose}
+      DEPENDS compress_texture "${data_dir}/${image}"
+      COMMENT "Compressing texture ${image}"
+      VERBATIM)
+    list(APPEND outputs ${output})
+  endforeach()
+
+  set(${out_var} ${outputs} PARENT_SCOPE)
+endfunction()
@@ -1,29 +1,38 @@
 #version 450
 
+#ifndef WORKGROUP_SIZE
 #define WORKGROUP_SIZE 32
+#endif
+
+// Blades in each tile slot of the blade buffers
+#ifndef BLADES_PER_TILE
+#define BLADES_PER_TILE 25600
+#endif
+
+// Set to 0 to build a variant that only simulates the blades
+#ifndef CULLING
+#define CULLING 1
+#endif
+
 layout(local_size_x = WORKGROUP_SIZE,
 local_size_y = 1,
 local_size_z = 1) in;
 
-layout(binding = 0) uniform CameraBufferObject {
-    mat4 view;
-    mat4 proj;
-    vec3 position;
-} camera;
+#include "include/camera.glsl"
+#include "include/debug_view.glsl"
+#include "include/grass_lod.glsl"
+#include "include/terrain.glsl"
 
-uniform float current_time;
-uniform float delta_time;
+// Written every frame through the upload ring
+layout(binding = 2, std140) uniform SimulationBufferObject {
+    float current_time;
+    float delta_time;
+    float wind_magnitude;
+    float wind_wave_length;
+    float wind_wave_period;
+} simulation;
 
-uniform float wind_magnitude;
-uniform float wind_wave_length;
-uniform float wind_wave_period;
-
-struct Blade {
-    vec4 v0;
-    vec4 v1;
-    vec4 v2;
-    vec4 up;
-};
+#include "include/blade.glsl"
 
 layout(binding = 1, std140) buffer inputBuffer {
     Blade inputBlades[];
@@ -33,14 +42,31 @@ layout(binding = 2, std140) buffer outputBuffer {
     Blade outputBlades[];
 };
 
-// Indirect drawing count
-layout(binding = 3) buffer NumBlades {
+// The tile held by each slot of the input blades, and the heightmap layer
+// of its terrain
+layout(binding = 5, std430) readonly buffer GrassTiles {
+    Tile grass_tiles[];
+};
+
+// Indirect drawing count, whose vertexCount the app clears before every
+// dispatch
+layout(binding = 3, std430) buffer NumBlades {
     uint vertexCount;
     uint instanceCount;// = 1
     uint firstVertex;// = 0
     uint firstInstance;// = 0
 } numBlades;
 
+// What became of the blades this dispatch, cleared before it and read back
+// a few frames later
+layout(binding = 6, std430) buffer GrassStatistics {
+    uint resident_blades;
+    uint frustum_culled;
+    uint distance_culled;
+    uint near_lod_patches;
+    uint far_lod_patches;
+} statistics;
+
 bool inBounds(float value, float bounds) {
     return (value >= -bounds) && (value <= bounds);
 }
@@ -49,14 +75,30 @@ float rand(float seed) {
     return fract(sin(seed)*100000.0);
 }
 
-void main() {
-    // Reset the number of blades to 0
-    if (gl_GlobalInvocationID.x == 0) {
-        numBlades.vertexCount = 0;
-    }
-    barrier();// Wait till all threads reach this point
+// The culling debug view draws the culled blades too, with the reason in
+// up.w: the stiffness, which only this shader reads
+void draw_culled(uint index, vec3 v0, vec3 v1, vec3 v2, float reason) {
+#if DEBUG_VIEW == DEBUG_VIEW_CULL_REASON
+    Blade blade = inputBlades[index];
+    blade.v0.xyz = v0;
+    blade.v1.xyz = v1;
+    blade.v2.xyz = v2;
+    blade.up.w = reason;
+    outputBlades[atomicAdd(numBlades.vertexCount, 1)] = blade;
+#endif
+}
 
+void main() {
     uint index = gl_GlobalInvocationID.x;
+    // The last workgroup is padded up to WORKGROUP_SIZE
+    if (index >= uint(inputBlades.length())) {
+        return;
+    }
+    Tile tile = grass_tiles[index / BLADES_PER_TILE];
+    if (tile.resident == 0u) {
+        return;
+    }
+    atomicAdd(statistics.resident_blades, 1);
     vec3 v0 = inputBlades[index].v0.xyz;
     vec3 v1 = inputBlades[index].v1.xyz;
     vec3 v2 = inputBlades[index].v2.xyz;
@@ -66,6 +108,14 @@ void main() {
     float width = inputBlades[index].v2.w;
     float stiffness = inputBlades[index].up.w;
 
+    // Keep the blade planted on the terrain. The blade is generated at y = 0
+    // and follows the heightmap when it changes
+    float ground_offset = terrain_height(v0.xz, tile) - v0.y;
+    v0.y += ground_offset;
+    v1.y += ground_offset;
+    v2.y += ground_offset;
+
+#if CULLING
     // Frustum culling
     vec4 v0ClipSpace = camera.proj * camera.view * vec4(v0, 1);
     vec4 v1ClipSpace = camera.proj * camera.view * vec4(v1, 1);
@@ -79,21 +129,32 @@ void main() {
     bool v1OutFrustum =
     v1ClipSpace.x < -1 || v1ClipSpace.x > 1
     || v1ClipSpace.y < -1 || v1ClipSpace.y > 1;
-    if (v0OutFrustum && v1OutFrustum) return;
+    if (v0OutFrustum && v1OutFrustum) {
+        atomicAdd(statistics.frustum_culled, 1);
+        draw_culled(index, v0, v1, v2, CULL_REASON_FRUSTUM);
+        return;
+    }
 
     // Distance culling
     const float far1 = 0.98;
     if (v0ClipSpace.z > far1 && v1ClipSpace.z > far1 && rand(index) > 0.7) {
+        atomicAdd(statistics.distance_culled, 1);
+        draw_culled(index, v0, v1, v2, CULL_REASON_DISTANCE);
         return;
     }
     const float far2 = 0.99;
     if (v0ClipSpace.z > far2 && v1ClipSpace.z > far2 && rand(index) > 0.3) {
+        atomicAdd(statistics.distance_culled, 1);
+        draw_culled(index, v0, v1, v2, CULL_REASON_DISTANCE);
         return;
     }
     const float far3 = 0.995;
     if (v0ClipSpace.z > far3 && v1ClipSpace.z > far3 && rand(index) > 0.2) {
+        atomicAdd(statistics.distance_culled, 1);
+        draw_culled(index, v0, v1, v2, CULL_REASON_DISTANCE);
         return;
     }
+#endif
 
     // Apply forces {
     //  Gravities
@@ -107,24 +168,34 @@ void main() {
     vec3 r = (v0 + up * height - v2) * stiffness;
 
     //  Wind
-    vec3 windForce = 0.25 * wind_magnitude *
+    vec3 windForce = 0.25 * simulation.wind_magnitude *
     vec3(
-    sin(current_time * 3. / wind_wave_period + v0.x * 0.1 * 11 / wind_wave_length),
+    sin(simulation.current_time * 3. / simulation.wind_wave_period + v0.x * 0.1 * 11 / simulation.wind_wave_length),
     0,
-    sin(current_time * 3. / wind_wave_period + v0.z * 0.2 * 11 / wind_wave_length) * 0.1
+    sin(simulation.current_time * 3. / simulation.wind_wave_period + v0.z * 0.2 * 11 / simulation.wind_wave_length) * 0.1
     );
     float fd = 1 - abs(dot(normalize(windForce), normalize(v2 - v0)));
     float fr = dot((v2 - v0), up) / height;
     vec3 w = windForce * fd * fr;
 
-    v2 += (0.1 * g + r + w) * delta_time;
+    v2 += (0.1 * g + r + w) * simulation.delta_time;
 
     float lproj = length(v2 - v0 - up * dot((v2-v0), up));
     v1 = v0 + height*up*max(1-lproj/height, 0.05*max(lproj/height, 1));
 
+    inputBlades[index].v0.xyz = v0;
     inputBlades[index].v1.xyz = v1;
     inputBlades[index].v2.xyz = v2;
     // }
 
-    outputBlades[atomicAdd(numBlades.vertexCount, 1)] = inputBlades[index];
+    if (near_lod(v1, v2)) {
+        atomicAdd(statistics.near_lod_patches, 1);
+    } else {
+        atomicAdd(statistics.far_lod_patches, 1);
+    }
+    const uint output_index = atomicAdd(numBlades.vertexCount, 1);
+    outputBlades[output_index] = inputBlades[index];
+#if DEBUG_VIEW == DEBUG_VIEW_CULL_REASON
+    outputBlades[output_index].up.w = CULL_REASON_NONE;
+#endif
 }
@@ -1,10 +1,16 @@
 #version 450
 
-layout(binding = 0) uniform CameraBufferObject {
-    mat4 view;
-    mat4 proj;
-    vec3 position;
-} camera;
+#include "include/camera.glsl"
+#include "include/debug_view.glsl"
+
+#if DEBUG_VIEW == DEBUG_VIEW_OVERDRAW
+// Count only the fragments that pass the depth test, which are the ones
+// shaded
+layout(early_fragment_tests) in;
+
+// Fragments shaded per pixel, see OverdrawHeatmap
+layout(binding = 0, r32ui) uniform uimage2D overdraw;
+#endif
 
 in TESE_OUT
 {
@@ -13,10 +19,21 @@ in TESE_OUT
   vec2 uv;
 } frag_in;
 
+#if DEBUG_VIEW == DEBUG_VIEW_LOD || DEBUG_VIEW == DEBUG_VIEW_CULL_REASON
+flat in vec3 debug_color;
+#endif
+
 layout(location = 0) out vec4 outColor;
 
 void main() {
   vec2 uv = frag_in.uv;
+#if DEBUG_VIEW == DEBUG_VIEW_OVERDRAW
+  imageAtomicAdd(overdraw, ivec2(gl_FragCoord.xy), 1u);
+#elif DEBUG_VIEW == DEBUG_VIEW_LOD || DEBUG_VIEW == DEBUG_VIEW_CULL_REASON
+  // Darker at the root, so that the blades stay apart
+  outColor = vec4(debug_color * mix(0.4, 1.0, uv.y), 1.0);
+  return;
+#endif
   vec3 normal = normalize(frag_in.normal);
 
   vec3 upperColor = vec3(0.4,1,0.1);
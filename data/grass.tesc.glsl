@@ -1,10 +1,7 @@
 #version 450
 
-layout(binding = 0) uniform CameraBufferObject {
-    mat4 view;
-    mat4 proj;
-    vec3 position;
-} camera;
+#include "include/camera.glsl"
+#include "include/grass_lod.glsl"
 
 in VS_OUT
 {
@@ -31,25 +28,21 @@ void main() {
   tesc_out.v2 = tesc_in[gl_InvocationID].v2;
   tesc_out.up = tesc_in[gl_InvocationID].up;
   tesc_out.dir = tesc_in[gl_InvocationID].dir;
-  
-  float z1 = (camera.proj * camera.view * vec4(tesc_out.v1.xyz, 1)).z;
-  float z2 = (camera.proj * camera.view * vec4(tesc_out.v2.xyz, 1)).z;
-
-
-  if (z1 < 0.8 && z2 < 0.8) {
-    gl_TessLevelInner[0] = 2.0;
-    gl_TessLevelInner[1] = 7.0;
-    gl_TessLevelOuter[0] = 7.0;
-    gl_TessLevelOuter[1] = 2.0;
-    gl_TessLevelOuter[2] = 7.0;
-    gl_TessLevelOuter[3] = 2.0;
+
+  if (near_lod(tesc_out.v1.xyz, tesc_out.v2.xyz)) {
+    gl_TessLevelInner[0] = NEAR_WIDTH_TESS_LEVEL;
+    gl_TessLevelInner[1] = NEAR_HEIGHT_TESS_LEVEL;
+    gl_TessLevelOuter[0] = NEAR_HEIGHT_TESS_LEVEL;
+    gl_TessLevelOuter[1] = NEAR_WIDTH_TESS_LEVEL;
+    gl_TessLevelOuter[2] = NEAR_HEIGHT_TESS_LEVEL;
+    gl_TessLevelOuter[3] = NEAR_WIDTH_TESS_LEVEL;
   } else {
-    gl_TessLevelInner[0] = 1.0;
-    gl_TessLevelInner[1] = 3.0;
-    gl_TessLevelOuter[0] = 3.0;
-    gl_TessLevelOuter[1] = 1.0;
-    gl_TessLevelOuter[2] = 3.0;
-    gl_TessLevelOuter[3] = 1.0;
+    gl_TessLevelInner[0] = FAR_WIDTH_TESS_LEVEL;
+    gl_TessLevelInner[1] = FAR_HEIGHT_TESS_LEVEL;
+    gl_TessLevelOuter[0] = FAR_HEIGHT_TESS_LEVEL;
+    gl_TessLevelOuter[1] = FAR_WIDTH_TESS_LEVEL;
+    gl_TessLevelOuter[2] = FAR_HEIGHT_TESS_LEVEL;
+    gl_TessLevelOuter[3] = FAR_WIDTH_TESS_LEVEL;
   }
 
 }
@@ -2,11 +2,9 @@
 
 layout(quads, equal_spacing, ccw) in;
 
-layout(binding = 0) uniform CameraBufferObject {
-    mat4 view;
-    mat4 proj;
-    vec3 position;
-} camera;
+#include "include/camera.glsl"
+#include "include/debug_view.glsl"
+#include "include/grass_lod.glsl"
 
 patch in TESC_OUT
 {
@@ -23,6 +21,13 @@ out TESE_OUT
   vec2 uv;
 } tese_out;
 
+// The depth prepass and the shading pass must agree on it to the bit
+invariant gl_Position;
+
+#if DEBUG_VIEW == DEBUG_VIEW_LOD || DEBUG_VIEW == DEBUG_VIEW_CULL_REASON
+flat out vec3 debug_color;
+#endif
+
 void main() {
   const float u = gl_TessCoord.x;
   const float v = gl_TessCoord.y;
@@ -49,4 +54,20 @@ void main() {
   tese_out.uv = vec2(u, v);
   tese_out.normal = normalize(cross(t0, t1));
   gl_Position = camera.proj * camera.view * vec4(p, 1.0);
+
+#if DEBUG_VIEW == DEBUG_VIEW_LOD
+  // Blue at the far tessellation level, red at the near one
+  const float level = (gl_TessLevelOuter[0] - FAR_HEIGHT_TESS_LEVEL) /
+                      (NEAR_HEIGHT_TESS_LEVEL - FAR_HEIGHT_TESS_LEVEL);
+  debug_color = mix(vec3(0.1, 0.3, 1.0), vec3(1.0, 0.2, 0.1), level);
+#elif DEBUG_VIEW == DEBUG_VIEW_CULL_REASON
+  const float reason = tese_in.up.w;
+  if (reason == CULL_REASON_FRUSTUM) {
+    debug_color = vec3(1.0, 0.1, 1.0);
+  } else if (reason == CULL_REASON_DISTANCE) {
+    debug_color = vec3(1.0, 0.6, 0.0);
+  } else {
+    debug_color = vec3(0.6);
+  }
+#endif
 }
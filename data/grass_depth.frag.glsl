@@ -0,0 +1,4 @@
+#version 450
+
+// The grass depth prepass only needs the depth the rasterizer writes
+void main() {}
@@ -0,0 +1,11 @@
+#ifndef BLADE_GLSL
+#define BLADE_GLSL
+
+struct Blade {
+    vec4 v0;// xyz: Position, w: orientation (in radius)
+    vec4 v1;// xyz: Bezier point w: height
+    vec4 v2;// xyz: Physical model guide w: width
+    vec4 up;// xyz: Up vector w: stiffness coefficient
+};
+
+#endif // BLADE_GLSL
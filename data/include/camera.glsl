@@ -0,0 +1,10 @@
+#ifndef CAMERA_GLSL
+#define CAMERA_GLSL
+
+layout(binding = 0, std140) uniform CameraBufferObject {
+    mat4 view;
+    mat4 proj;
+    vec3 position;
+} camera;
+
+#endif // CAMERA_GLSL
@@ -0,0 +1,21 @@
+#ifndef DEBUG_VIEW_GLSL
+#define DEBUG_VIEW_GLSL
+
+// The debug views of the grass, one shader permutation each. Must match
+// Grasses::DebugView
+#define DEBUG_VIEW_NONE 0
+#define DEBUG_VIEW_OVERDRAW 1
+#define DEBUG_VIEW_LOD 2
+#define DEBUG_VIEW_CULL_REASON 3
+
+#ifndef DEBUG_VIEW
+#define DEBUG_VIEW DEBUG_VIEW_NONE
+#endif
+
+// Why a blade drawn by the culling view would have been culled, carried in
+// up.w of the culled blades
+#define CULL_REASON_NONE 0.0
+#define CULL_REASON_FRUSTUM 1.0
+#define CULL_REASON_DISTANCE 2.0
+
+#endif // DEBUG_VIEW_GLSL
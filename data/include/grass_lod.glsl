@@ -0,0 +1,33 @@
+#ifndef GRASS_LOD_GLSL
+#define GRASS_LOD_GLSL
+
+// Needs include/camera.glsl
+
+// Blades whose v1 and v2 are closer than this NDC depth get the near levels
+#ifndef LOD_DEPTH_THRESHOLD
+#define LOD_DEPTH_THRESHOLD 0.8
+#endif
+
+// Tessellation levels across the width and along the height of a blade
+#ifndef NEAR_WIDTH_TESS_LEVEL
+#define NEAR_WIDTH_TESS_LEVEL 2.0
+#endif
+#ifndef NEAR_HEIGHT_TESS_LEVEL
+#define NEAR_HEIGHT_TESS_LEVEL 7.0
+#endif
+#ifndef FAR_WIDTH_TESS_LEVEL
+#define FAR_WIDTH_TESS_LEVEL 1.0
+#endif
+#ifndef FAR_HEIGHT_TESS_LEVEL
+#define FAR_HEIGHT_TESS_LEVEL 3.0
+#endif
+
+// Whether the tessellation control shader gives the blade its near levels.
+// The culling compute shader counts the patches of each level with it
+bool near_lod(vec3 v1, vec3 v2) {
+    float z1 = (camera.proj * camera.view * vec4(v1, 1)).z;
+    float z2 = (camera.proj * camera.view * vec4(v2, 1)).z;
+    return z1 < LOD_DEPTH_THRESHOLD && z2 < LOD_DEPTH_THRESHOLD;
+}
+
+#endif // GRASS_LOD_GLSL
@@ -0,0 +1,51 @@
+#ifndef TERRAIN_GLSL
+#define TERRAIN_GLSL
+
+layout(binding = 1, std140) uniform TerrainBufferObject {
+    float tile_size;// World extent of a tile
+    float height_scale;// World height of a heightmap value of 1
+    float tessellation_factor;// Tessellation level of a 1 m edge seen from 1 m
+    uint patches_per_side;// Patches across a tile
+} terrain;
+
+// A resident tile and the heightmap layer that holds its heights
+struct Tile {
+    ivec2 coord;
+    int layer;
+    uint resident;
+};
+
+// The tiles drawn by the terrain program, one per instance
+layout(binding = 4, std430) readonly buffer TerrainTiles {
+    Tile terrain_tiles[];
+};
+
+// One layer per resident tile. The heightmaps are sampled on a grid whose
+// outer samples lie exactly on the tile edges, so adjacent tiles agree on the
+// height along the edge they share. One more ring of samples outside of the
+// tile lets the normals be differenced across the edge
+layout(binding = 1) uniform sampler2DArray heightmaps;
+
+// Samples across a tile, from edge to edge
+float heightmap_samples() {
+    return float(textureSize(heightmaps, 0).x - 2);
+}
+
+vec3 heightmap_coord(vec2 xz, Tile tile) {
+    float resolution = float(textureSize(heightmaps, 0).x);
+    vec2 local = xz / terrain.tile_size - vec2(tile.coord);
+    return vec3((local * (heightmap_samples() - 1.0) + 1.5) / resolution, float(tile.layer));
+}
+
+float terrain_height(vec2 xz, Tile tile) {
+    return textureLod(heightmaps, heightmap_coord(xz, tile), 0).r * terrain.height_scale;
+}
+
+vec3 terrain_normal(vec2 xz, Tile tile) {
+    float texel = terrain.tile_size / (heightmap_samples() - 1.0);
+    float dx = terrain_height(xz + vec2(texel, 0), tile) - terrain_height(xz - vec2(texel, 0), tile);
+    float dz = terrain_height(xz + vec2(0, texel), tile) - terrain_height(xz - vec2(0, texel), tile);
+    return normalize(vec3(-dx / (2 * texel), 1, -dz / (2 * texel)));
+}
+
+#endif // TERRAIN_GLSL
@@ -1,18 +0,0 @@
-#version 450 core
-out vec4 FragColor;
-
-in vec2 TexCoord;
-
-// texture samplers
-uniform sampler2D texture1;
-
-layout(binding = 0) uniform CameraBufferObject {
-    mat4 view;
-    mat4 proj;
-    vec3 position;
-} camera;
-
-void main()
-{
-	FragColor = texture(texture1, TexCoord);
-}
@@ -0,0 +1,27 @@
+#version 450
+
+// Fragments per pixel shown at full heat
+#ifndef OVERDRAW_RANGE
+#define OVERDRAW_RANGE 16
+#endif
+
+// Counted by the grass in the overdraw view. Read and cleared here
+layout(binding = 0, r32ui) uniform coherent uimage2D overdraw;
+
+layout(location = 0) out vec4 outColor;
+
+// Blue through green and yellow to red
+vec3 heat(float t) {
+  return clamp(vec3(1.5 - abs(4.0 * t - vec3(3.0, 2.0, 1.0))), 0.0, 1.0);
+}
+
+void main()
+{
+  const ivec2 pixel = ivec2(gl_FragCoord.xy);
+  const uint count = imageLoad(overdraw, pixel).r;
+  imageStore(overdraw, pixel, uvec4(0));
+  if (count == 0u) {
+    discard;
+  }
+  outColor = vec4(heat(min(float(count) / float(OVERDRAW_RANGE), 1.0)), 1.0);
+}
@@ -4,14 +4,11 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-layout(binding = 0) uniform CameraBufferObject {
-  mat4 view;
-  mat4 proj;
-  vec3 position;
-} camera;
+#include "include/camera.glsl"
 
 void main()
 {
   TexCoords = aPos;
-  gl_Position = camera.proj * vec4(aPos, 1.0);
+  // At the far plane, drawn after the opaque geometry where it covers nothing
+  gl_Position = (camera.proj * vec4(aPos, 1.0)).xyww;
 }  
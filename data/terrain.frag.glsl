@@ -0,0 +1,19 @@
+#version 450 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec2 WorldXZ;
+flat in int TileIndex;
+
+// Unit 2 has the mipmapped sampler of the ground to itself
+layout(binding = 2) uniform sampler2D ground_texture;
+
+#include "include/terrain.glsl"
+
+const vec3 sun_direction = normalize(vec3(0.4, 1.0, 0.3));
+
+void main()
+{
+    float lighting = 0.4 + 0.6 * max(dot(terrain_normal(WorldXZ, terrain_tiles[TileIndex]), sun_direction), 0.0);
+    FragColor = vec4(texture(ground_texture, TexCoord).rgb * lighting, 1.0);
+}
@@ -0,0 +1,76 @@
+#version 450 core
+
+// Continuous LOD: each edge is tessellated according to the distance of its
+// midpoint to the camera. Neighbouring patches compute the same level for the
+// edge they share, so there are no cracks between them
+
+#include "include/camera.glsl"
+#include "include/terrain.glsl"
+
+#ifndef MAX_TESS_LEVEL
+#define MAX_TESS_LEVEL 64.0
+#endif
+
+layout(vertices = 4) out;
+
+in int vs_tile[];
+patch out int tile_index;
+
+float edge_level(vec3 a, vec3 b, Tile tile)
+{
+    vec3 midpoint = (a + b) * 0.5;
+    midpoint.y = terrain_height(midpoint.xz, tile);
+    float distance_to_camera = max(distance(midpoint, camera.position), 0.01);
+    return clamp(terrain.tessellation_factor * distance(a, b) / distance_to_camera,
+                 1.0, MAX_TESS_LEVEL);
+}
+
+// Whether the box spanning the patch and the whole height range may be
+// visible
+bool in_frustum()
+{
+    mat4 view_proj = camera.proj * camera.view;
+    // Number of corners outside of each pair of clip planes
+    ivec3 below = ivec3(0);
+    ivec3 above = ivec3(0);
+    for (int i = 0; i < 8; ++i) {
+        vec3 corner = gl_in[i % 4].gl_Position.xyz;
+        corner.y = i < 4 ? 0.0 : terrain.height_scale;
+        vec4 clip = view_proj * vec4(corner, 1);
+        below += ivec3(lessThan(clip.xyz, -clip.www));
+        above += ivec3(greaterThan(clip.xyz, clip.www));
+    }
+    return all(lessThan(below, ivec3(8))) && all(lessThan(above, ivec3(8)));
+}
+
+void main()
+{
+    gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
+
+    if (gl_InvocationID == 0) {
+        tile_index = vs_tile[0];
+        if (!in_frustum()) {
+            // A level of 0 discards the patch
+            gl_TessLevelOuter[0] = 0.0;
+            gl_TessLevelOuter[1] = 0.0;
+            gl_TessLevelOuter[2] = 0.0;
+            gl_TessLevelOuter[3] = 0.0;
+            gl_TessLevelInner[0] = 0.0;
+            gl_TessLevelInner[1] = 0.0;
+            return;
+        }
+
+        Tile tile = terrain_tiles[vs_tile[0]];
+        vec3 p0 = gl_in[0].gl_Position.xyz;
+        vec3 p1 = gl_in[1].gl_Position.xyz;
+        vec3 p2 = gl_in[2].gl_Position.xyz;
+        vec3 p3 = gl_in[3].gl_Position.xyz;
+        // Edges u = 0, v = 0, u = 1 and v = 1
+        gl_TessLevelOuter[0] = edge_level(p0, p3, tile);
+        gl_TessLevelOuter[1] = edge_level(p0, p1, tile);
+        gl_TessLevelOuter[2] = edge_level(p1, p2, tile);
+        gl_TessLevelOuter[3] = edge_level(p3, p2, tile);
+        gl_TessLevelInner[0] = max(gl_TessLevelOuter[1], gl_TessLevelOuter[3]);
+        gl_TessLevelInner[1] = max(gl_TessLevelOuter[0], gl_TessLevelOuter[2]);
+    }
+}
@@ -0,0 +1,27 @@
+#version 450 core
+
+layout(quads, fractional_even_spacing, ccw) in;
+
+#include "include/camera.glsl"
+#include "include/terrain.glsl"
+
+patch in int tile_index;
+
+out vec2 TexCoord;
+out vec2 WorldXZ;
+flat out int TileIndex;
+
+void main()
+{
+    vec2 uv = gl_TessCoord.xy;
+    vec3 position = mix(mix(gl_in[0].gl_Position.xyz, gl_in[1].gl_Position.xyz, uv.x),
+                        mix(gl_in[3].gl_Position.xyz, gl_in[2].gl_Position.xyz, uv.x),
+                        uv.y);
+    position.y = terrain_height(position.xz, terrain_tiles[tile_index]);
+
+    gl_Position = camera.proj * camera.view * vec4(position, 1.0);
+    // The ground texture repeats every 2 m
+    TexCoord = position.xz * 0.5;
+    WorldXZ = position.xz;
+    TileIndex = tile_index;
+}
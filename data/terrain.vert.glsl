@@ -0,0 +1,27 @@
+#version 450 core
+
+// Attributeless: instance i draws the tile terrain_tiles[i], and every 4
+// vertices are the corners of one patch of the tile's
+// patches_per_side x patches_per_side grid
+
+#include "include/terrain.glsl"
+
+out int vs_tile;
+
+const ivec2 corners[4] = ivec2[](ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 1));
+
+void main()
+{
+    Tile tile = terrain_tiles[gl_InstanceID];
+    int patches = int(terrain.patches_per_side);
+    int patch_index = gl_VertexID / 4;
+    ivec2 cell = ivec2(patch_index % patches, patch_index / patches);
+    // In whole patches from the world origin, so that the corners shared by
+    // neighbouring tiles are bit-identical
+    ivec2 grid = tile.coord * patches + cell + corners[gl_VertexID % 4];
+    vec2 xz = vec2(grid) * (terrain.tile_size / float(patches));
+
+    vs_tile = gl_InstanceID;
+    // Heights are applied after tessellation
+    gl_Position = vec4(xz.x, 0, xz.y, 1);
+}
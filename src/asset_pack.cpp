@@ -0,0 +1,184 @@
+#include "asset_pack.hpp"
+#include "lz4_block.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::unique_ptr<AssetPack> mounted_pack;
+
+[[nodiscard]] std::optional<std::vector<unsigned char>>
+read_loose_file(std::string_view name)
+{
+  std::ifstream file{std::string{name}, std::ios::binary};
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  return std::vector<unsigned char>{std::istreambuf_iterator<char>{file},
+                                    std::istreambuf_iterator<char>{}};
+}
+
+} // anonymous namespace
+
+AssetPack::AssetPack(const std::string& path)
+{
+#ifdef _WIN32
+  file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    file_ = nullptr;
+    throw std::runtime_error{fmt::format("Cannot open asset pack {}", path)};
+  }
+  LARGE_INTEGER file_size;
+  GetFileSizeEx(file_, &file_size);
+  size_ = static_cast<std::size_t>(file_size.QuadPart);
+  mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_ != nullptr) {
+    data_ = static_cast<const unsigned char*>(
+        MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  }
+#else
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error{fmt::format("Cannot open asset pack {}", path)};
+  }
+  struct stat file_stat {};
+  if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+    size_ = static_cast<std::size_t>(file_stat.st_size);
+    void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+      data_ = static_cast<const unsigned char*>(mapped);
+    }
+  }
+  // The mapping keeps the file alive
+  close(fd);
+#endif
+
+  if (data_ == nullptr) {
+    throw std::runtime_error{fmt::format("Cannot map asset pack {}", path)};
+  }
+
+  PackHeader header;
+  if (size_ < sizeof(header)) {
+    throw std::runtime_error{fmt::format("{} is not an asset pack", path)};
+  }
+  std::memcpy(&header, data_, sizeof(header));
+  if (std::memcmp(header.magic, pack_magic, sizeof(pack_magic)) != 0 ||
+      header.version != pack_version) {
+    throw std::runtime_error{fmt::format(
+        "{} is not an asset pack of version {}", path, pack_version)};
+  }
+
+  const std::size_t names_offset =
+      sizeof(PackHeader) + header.entry_count * sizeof(PackEntry);
+  if (names_offset + header.names_size > size_) {
+    throw std::runtime_error{fmt::format("Asset pack {} is truncated", path)};
+  }
+  // The header is 16 bytes and page-aligned, so the entries are aligned
+  entries_ = {reinterpret_cast<const PackEntry*>(data_ + sizeof(PackHeader)),
+              header.entry_count};
+  names_ = {reinterpret_cast<const char*>(data_ + names_offset),
+            header.names_size};
+
+  for (const auto& entry : entries_) {
+    if (entry.offset > size_ || entry.stored_size > size_ - entry.offset ||
+        std::size_t{entry.name_offset} + entry.name_length > names_.size()) {
+      throw std::runtime_error{
+          fmt::format("Asset pack {} has a corrupted index", path)};
+    }
+  }
+}
+
+AssetPack::~AssetPack()
+{
+#ifdef _WIN32
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_ != nullptr) {
+    CloseHandle(mapping_);
+  }
+  if (file_ != nullptr) {
+    CloseHandle(file_);
+  }
+#else
+  if (data_ != nullptr) {
+    munmap(const_cast<unsigned char*>(data_), size_);
+  }
+#endif
+}
+
+std::string_view AssetPack::name_of(const PackEntry& entry) const
+{
+  return names_.substr(entry.name_offset, entry.name_length);
+}
+
+std::optional<Asset> AssetPack::find(std::string_view name) const
+{
+  const auto it = std::lower_bound(
+      entries_.begin(), entries_.end(), name,
+      [this](const PackEntry& entry, std::string_view key) {
+        return name_of(entry) < key;
+      });
+  if (it == entries_.end() || name_of(*it) != name) {
+    return std::nullopt;
+  }
+
+  const std::span<const unsigned char> stored{data_ + it->offset,
+                                              it->stored_size};
+  switch (it->compression) {
+  case PackCompression::none:
+    return Asset{stored};
+  case PackCompression::lz4: {
+    std::vector<unsigned char> decompressed(it->size);
+    if (!lz4_decompress(stored, decompressed)) {
+      throw std::runtime_error{
+          fmt::format("Corrupted asset {} in the asset pack", name)};
+    }
+    return Asset{std::move(decompressed)};
+  }
+  }
+  throw std::runtime_error{
+      fmt::format("Unknown compression for asset {} in the asset pack", name)};
+}
+
+bool mount_asset_pack(const std::string& path)
+{
+  if (!std::filesystem::exists(path)) {
+    return false;
+  }
+  mounted_pack = std::make_unique<AssetPack>(path);
+  return true;
+}
+
+std::optional<Asset> load_asset(std::string_view name)
+{
+  if (mounted_pack != nullptr) {
+    if (auto asset = mounted_pack->find(name)) {
+      return asset;
+    }
+  }
+  if (auto bytes = read_loose_file(name)) {
+    return Asset{std::move(*bytes)};
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,97 @@
+#ifndef GLGRASSRENDERER_ASSET_PACK_HPP
+#define GLGRASSRENDERER_ASSET_PACK_HPP
+
+#include "asset_pack_format.hpp"
+
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief The bytes of an asset
+ *
+ * Either a view into a memory-mapped asset pack, or owned when the asset had
+ * to be decompressed or was read from a loose file.
+ */
+class Asset {
+public:
+  explicit Asset(std::span<const unsigned char> view) : bytes_{view} {}
+  explicit Asset(std::vector<unsigned char> owned)
+      : owned_{std::move(owned)}, bytes_{owned_}
+  {
+  }
+
+  Asset(const Asset&) = delete;
+  Asset& operator=(const Asset&) = delete;
+  Asset(Asset&&) noexcept = default;
+  Asset& operator=(Asset&&) noexcept = default;
+
+  [[nodiscard]] const unsigned char* data() const noexcept
+  {
+    return bytes_.data();
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    return bytes_.size();
+  }
+
+  [[nodiscard]] std::string_view text() const noexcept
+  {
+    return {reinterpret_cast<const char*>(bytes_.data()), bytes_.size()};
+  }
+
+  /// Whether the bytes live in the mapped pack, which outlives the Asset
+  [[nodiscard]] bool is_view() const noexcept
+  {
+    return owned_.empty();
+  }
+
+private:
+  std::vector<unsigned char> owned_;
+  std::span<const unsigned char> bytes_;
+};
+
+/**
+ * @brief A memory-mapped archive of the data directory
+ *
+ * Uncompressed entries are returned as zero-copy views into the mapping.
+ */
+class AssetPack {
+public:
+  /// Throws std::runtime_error if the file cannot be mapped or is not a pack
+  explicit AssetPack(const std::string& path);
+  ~AssetPack();
+
+  AssetPack(const AssetPack&) = delete;
+  AssetPack& operator=(const AssetPack&) = delete;
+  AssetPack(AssetPack&&) = delete;
+  AssetPack& operator=(AssetPack&&) = delete;
+
+  [[nodiscard]] std::optional<Asset> find(std::string_view name) const;
+
+private:
+  const unsigned char* data_ = nullptr;
+  std::size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+
+  std::span<const PackEntry> entries_;
+  std::string_view names_;
+
+  [[nodiscard]] std::string_view name_of(const PackEntry& entry) const;
+};
+
+/// Mounts the pack that load_asset() reads from. Returns false if the pack
+/// does not exist, and throws if it exists but is invalid
+bool mount_asset_pack(const std::string& path);
+
+/// Reads `name` (relative to the data directory) from the mounted pack,
+/// falling back to the loose file
+[[nodiscard]] std::optional<Asset> load_asset(std::string_view name);
+
+#endif // GLGRASSRENDERER_ASSET_PACK_HPP
@@ -0,0 +1,45 @@
+#ifndef GLGRASSRENDERER_ASSET_PACK_FORMAT_HPP
+#define GLGRASSRENDERER_ASSET_PACK_FORMAT_HPP
+
+#include <bit>
+#include <cstdint>
+
+// On-disk layout of the asset pack written by the pack_assets tool:
+//
+//   PackHeader
+//   PackEntry[entry_count]   sorted by name
+//   names                    names_size bytes, not null-terminated
+//   data                     each entry aligned to pack_alignment
+//
+// All integers are little-endian.
+
+static_assert(std::endian::native == std::endian::little,
+              "The asset pack is read in place on little-endian hosts only");
+
+inline constexpr char pack_magic[4] = {'G', 'P', 'A', 'K'};
+inline constexpr std::uint32_t pack_version = 1;
+inline constexpr std::uint64_t pack_alignment = 16;
+
+enum class PackCompression : std::uint32_t { none = 0, lz4 = 1 };
+
+struct PackHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t entry_count;
+  std::uint32_t names_size;
+};
+
+struct PackEntry {
+  std::uint64_t offset; // From the start of the file
+  std::uint64_t stored_size;
+  std::uint64_t size; // Once decompressed
+  std::uint32_t name_offset;
+  std::uint32_t name_length;
+  PackCompression compression;
+  std::uint32_t reserved;
+};
+
+static_assert(sizeof(PackHeader) == 16);
+static_assert(sizeof(PackEntry) == 40);
+
+#endif // GLGRASSRENDERER_ASSET_PACK_FORMAT_HPP
@@ -0,0 +1,203 @@
+#include "bc1.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+using Color = std::array<float, 3>;
+
+[[nodiscard]] std::uint16_t to_565(const Color& color) noexcept
+{
+  const auto quantize = [](float value, float max) {
+    return static_cast<std::uint16_t>(
+        std::lround(std::clamp(value, 0.0f, 255.0f) * max / 255.0f));
+  };
+  return static_cast<std::uint16_t>((quantize(color[0], 31.0f) << 11) |
+                                    (quantize(color[1], 63.0f) << 5) |
+                                    quantize(color[2], 31.0f));
+}
+
+[[nodiscard]] Color from_565(std::uint16_t packed) noexcept
+{
+  const auto expand = [](unsigned value, unsigned bits) {
+    const auto expanded = (value << (8 - bits)) | (value >> (2 * bits - 8));
+    return static_cast<float>(expanded);
+  };
+  return {expand(packed >> 11u, 5), expand((packed >> 5u) & 0x3Fu, 6),
+          expand(packed & 0x1Fu, 5)};
+}
+
+[[nodiscard]] float distance_squared(const Color& lhs,
+                                     const Color& rhs) noexcept
+{
+  float sum = 0.0f;
+  for (std::size_t i = 0; i < 3; ++i) {
+    sum += (lhs[i] - rhs[i]) * (lhs[i] - rhs[i]);
+  }
+  return sum;
+}
+
+/// The four-color palette of a block with color0 > color1
+[[nodiscard]] std::array<Color, 4> palette(std::uint16_t color0,
+                                           std::uint16_t color1) noexcept
+{
+  const auto c0 = from_565(color0);
+  const auto c1 = from_565(color1);
+  std::array<Color, 4> colors{c0, c1, {}, {}};
+  for (std::size_t i = 0; i < 3; ++i) {
+    colors[2][i] = (2.0f * c0[i] + c1[i]) / 3.0f;
+    colors[3][i] = (c0[i] + 2.0f * c1[i]) / 3.0f;
+  }
+  return colors;
+}
+
+/// Fits the endpoints along the principal axis of the block's colors
+void compress_block(const std::array<Color, 16>& texels, unsigned char* out)
+{
+  Color mean{};
+  for (const auto& texel : texels) {
+    for (std::size_t i = 0; i < 3; ++i) {
+      mean[i] += texel[i] / 16.0f;
+    }
+  }
+
+  std::array<float, 6> covariance{};
+  for (const auto& texel : texels) {
+    const Color d{texel[0] - mean[0], texel[1] - mean[1], texel[2] - mean[2]};
+    covariance[0] += d[0] * d[0];
+    covariance[1] += d[0] * d[1];
+    covariance[2] += d[0] * d[2];
+    covariance[3] += d[1] * d[1];
+    covariance[4] += d[1] * d[2];
+    covariance[5] += d[2] * d[2];
+  }
+
+  // Power iteration converges quickly enough for a 3x3 matrix
+  Color axis{1.0f, 1.0f, 1.0f};
+  for (int iteration = 0; iteration < 8; ++iteration) {
+    const Color next{
+        covariance[0] * axis[0] + covariance[1] * axis[1] +
+            covariance[2] * axis[2],
+        covariance[1] * axis[0] + covariance[3] * axis[1] +
+            covariance[4] * axis[2],
+        covariance[2] * axis[0] + covariance[4] * axis[1] +
+            covariance[5] * axis[2]};
+    const float length = std::sqrt(distance_squared(next, Color{}));
+    if (length < 1e-6f) {
+      break;
+    }
+    axis = {next[0] / length, next[1] / length, next[2] / length};
+  }
+
+  float min_projection = 0.0f;
+  float max_projection = 0.0f;
+  for (const auto& texel : texels) {
+    const float projection = (texel[0] - mean[0]) * axis[0] +
+                             (texel[1] - mean[1]) * axis[1] +
+                             (texel[2] - mean[2]) * axis[2];
+    min_projection = std::min(min_projection, projection);
+    max_projection = std::max(max_projection, projection);
+  }
+
+  const auto endpoint = [&](float projection) {
+    return to_565({mean[0] + axis[0] * projection,
+                   mean[1] + axis[1] * projection,
+                   mean[2] + axis[2] * projection});
+  };
+  auto color0 = endpoint(max_projection);
+  auto color1 = endpoint(min_projection);
+  if (color0 < color1) {
+    std::swap(color0, color1);
+  }
+
+  std::uint32_t indices = 0;
+  // Equal endpoints would select the three-color mode, index 0 is exact
+  if (color0 != color1) {
+    const auto colors = palette(color0, color1);
+    for (std::size_t t = 0; t < 16; ++t) {
+      std::uint32_t best = 0;
+      float best_distance = distance_squared(texels[t], colors[0]);
+      for (std::uint32_t c = 1; c < 4; ++c) {
+        const float distance = distance_squared(texels[t], colors[c]);
+        if (distance < best_distance) {
+          best = c;
+          best_distance = distance;
+        }
+      }
+      indices |= best << (2 * t);
+    }
+  }
+
+  out[0] = static_cast<unsigned char>(color0 & 0xFFu);
+  out[1] = static_cast<unsigned char>(color0 >> 8u);
+  out[2] = static_cast<unsigned char>(color1 & 0xFFu);
+  out[3] = static_cast<unsigned char>(color1 >> 8u);
+  for (std::size_t i = 0; i < 4; ++i) {
+    out[4 + i] = static_cast<unsigned char>((indices >> (8 * i)) & 0xFFu);
+  }
+}
+
+} // anonymous namespace
+
+std::vector<unsigned char> bc1_compress(std::span<const unsigned char> pixels,
+                                        std::size_t width, std::size_t height,
+                                        std::size_t channels)
+{
+  std::vector<unsigned char> blocks(bc1_image_size(width, height));
+  auto* out = blocks.data();
+  for (std::size_t block_y = 0; block_y < height; block_y += 4) {
+    for (std::size_t block_x = 0; block_x < width; block_x += 4) {
+      std::array<Color, 16> texels;
+      for (std::size_t t = 0; t < 16; ++t) {
+        const auto x = std::min(block_x + t % 4, width - 1);
+        const auto y = std::min(block_y + t / 4, height - 1);
+        const auto* pixel = &pixels[(y * width + x) * channels];
+        for (std::size_t i = 0; i < 3; ++i) {
+          texels[t][i] = static_cast<float>(pixel[channels < 3 ? 0 : i]);
+        }
+      }
+      compress_block(texels, out);
+      out += bc1_block_size;
+    }
+  }
+  return blocks;
+}
+
+std::vector<unsigned char> bc1_decompress(std::span<const unsigned char> blocks,
+                                          std::size_t width, std::size_t height)
+{
+  std::vector<unsigned char> pixels(width * height * 4);
+  const auto* block = blocks.data();
+  for (std::size_t block_y = 0; block_y < height; block_y += 4) {
+    for (std::size_t block_x = 0; block_x < width; block_x += 4) {
+      const auto color0 = static_cast<std::uint16_t>(block[0] | block[1] << 8);
+      const auto color1 = static_cast<std::uint16_t>(block[2] | block[3] << 8);
+      auto colors = palette(color0, color1);
+      if (color0 <= color1) {
+        for (std::size_t i = 0; i < 3; ++i) {
+          colors[2][i] = (colors[0][i] + colors[1][i]) / 2.0f;
+          colors[3][i] = 0.0f;
+        }
+      }
+
+      for (std::size_t t = 0; t < 16; ++t) {
+        const auto x = block_x + t % 4;
+        const auto y = block_y + t / 4;
+        if (x >= width || y >= height) {
+          continue;
+        }
+        const auto index = (block[4 + t / 4] >> (2 * (t % 4))) & 0x3u;
+        auto* pixel = &pixels[(y * width + x) * 4];
+        for (std::size_t i = 0; i < 3; ++i) {
+          pixel[i] = static_cast<unsigned char>(std::lround(colors[index][i]));
+        }
+        pixel[3] = color0 <= color1 && index == 3 ? 0 : 255;
+      }
+      block += bc1_block_size;
+    }
+  }
+  return pixels;
+}
@@ -0,0 +1,31 @@
+#ifndef GLGRASSRENDERER_BC1_HPP
+#define GLGRASSRENDERER_BC1_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// BC1 (DXT1) block compression of opaque RGB images. Each 4x4 texel block is
+// stored in 8 bytes: two RGB565 endpoints and 2-bit palette indices.
+
+inline constexpr std::size_t bc1_block_size = 8;
+
+/// Size in bytes of a `width` x `height` image once compressed
+[[nodiscard]] constexpr std::size_t bc1_image_size(std::size_t width,
+                                                   std::size_t height) noexcept
+{
+  return (width + 3) / 4 * ((height + 3) / 4) * bc1_block_size;
+}
+
+/// Compresses tightly packed pixels with `channels` 8-bit channels. Only the
+/// first three channels are used; edge blocks repeat the last row and column
+[[nodiscard]] std::vector<unsigned char>
+bc1_compress(std::span<const unsigned char> pixels, std::size_t width,
+             std::size_t height, std::size_t channels);
+
+/// Decompresses to tightly packed RGBA8 pixels, for drivers without S3TC
+[[nodiscard]] std::vector<unsigned char>
+bc1_decompress(std::span<const unsigned char> blocks, std::size_t width,
+               std::size_t height);
+
+#endif // GLGRASSRENDERER_BC1_HPP
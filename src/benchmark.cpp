@@ -0,0 +1,202 @@
+#include "benchmark.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+/// Splits `line` at spaces and tabs
+[[nodiscard]] std::vector<std::string_view> split_fields(std::string_view line)
+{
+  std::vector<std::string_view> fields;
+  std::size_t begin = line.find_first_not_of(" \t");
+  while (begin != std::string_view::npos) {
+    const std::size_t end = line.find_first_of(" \t", begin);
+    fields.push_back(line.substr(begin, end - begin));
+    begin = line.find_first_not_of(" \t", end);
+  }
+  return fields;
+}
+
+[[nodiscard]] std::string json_string(std::string_view text)
+{
+  std::string escaped = "\"";
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += fmt::format("\\u{:04x}", static_cast<unsigned char>(c));
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped + '"';
+}
+
+[[nodiscard]] std::ofstream open_report(const std::string& path)
+{
+  std::ofstream file{path};
+  if (!file) {
+    throw std::runtime_error{
+        fmt::format("Failed to open {} for writing", path)};
+  }
+  return file;
+}
+
+} // anonymous namespace
+
+CameraPath CameraPath::parse(std::string_view text)
+{
+  CameraPath path;
+  std::size_t line_number = 0;
+  while (!text.empty()) {
+    const std::size_t end = std::min(text.find('\n'), text.size());
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(std::min(end + 1, text.size()));
+    ++line_number;
+
+    if (const auto comment = line.find('#'); comment != line.npos) {
+      line = line.substr(0, comment);
+    }
+    const auto fields = split_fields(line);
+    if (fields.empty()) {
+      continue;
+    }
+
+    float values[6] = {};
+    bool valid = fields.size() == std::size(values);
+    for (std::size_t i = 0; valid && i < fields.size(); ++i) {
+      // Tolerate CRLF line endings
+      std::string_view field = fields[i];
+      if (field.ends_with('\r')) {
+        field.remove_suffix(1);
+      }
+      const auto [ptr, error] =
+          std::from_chars(field.data(), field.data() + field.size(), values[i]);
+      valid = error == std::errc{} && ptr == field.data() + field.size();
+    }
+    if (!valid) {
+      throw std::runtime_error{fmt::format(
+          "Camera path line {}: expected 'time x y z yaw pitch'", line_number)};
+    }
+
+    const CameraKeyframe keyframe{
+        values[0], glm::vec3(values[1], values[2], values[3]), values[4],
+        values[5]};
+    if (!path.keyframes_.empty() &&
+        keyframe.time <= path.keyframes_.back().time) {
+      throw std::runtime_error{fmt::format(
+          "Camera path line {}: times must increase", line_number)};
+    }
+    path.keyframes_.push_back(keyframe);
+  }
+
+  if (path.keyframes_.empty()) {
+    throw std::runtime_error{"Camera path has no keyframes"};
+  }
+  return path;
+}
+
+CameraKeyframe CameraPath::sample(float time) const
+{
+  const float start = keyframes_.front().time;
+  const float length = duration() - start;
+  if (length <= 0) {
+    return keyframes_.front();
+  }
+  time = start + std::fmod(std::max(time - start, 0.0f), length);
+
+  const auto next =
+      std::upper_bound(keyframes_.begin(), keyframes_.end(), time,
+                       [](float t, const CameraKeyframe& keyframe) {
+                         return t < keyframe.time;
+                       });
+  if (next == keyframes_.end()) {
+    return keyframes_.back();
+  }
+  const auto& b = *next;
+  const auto& a = *std::prev(next);
+  const float t = (time - a.time) / (b.time - a.time);
+  return {time, glm::mix(a.position, b.position, t), glm::mix(a.yaw, b.yaw, t),
+          glm::mix(a.pitch, b.pitch, t)};
+}
+
+BenchmarkReport::BenchmarkReport(std::vector<std::string> metrics)
+    : metrics_{std::move(metrics)}, values_(metrics_.size())
+{
+}
+
+void BenchmarkReport::add_frame(std::span<const double> values)
+{
+  if (values.size() != metrics_.size()) {
+    throw std::runtime_error{
+        fmt::format("Benchmark frame has {} values for {} metrics",
+                    values.size(), metrics_.size())};
+  }
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    values_[i].push_back(values[i]);
+  }
+}
+
+FrameStatistics BenchmarkReport::statistics(std::size_t metric) const
+{
+  return summarize_frame_times(values_.at(metric));
+}
+
+void BenchmarkReport::write_json(const std::string& path,
+                                 const BenchmarkInfo& info) const
+{
+  auto file = open_report(path);
+  file << "{\n";
+  file << fmt::format("  \"renderer\": {},\n", json_string(info.renderer));
+  file << fmt::format("  \"camera_path\": {},\n",
+                      json_string(info.camera_path));
+  file << fmt::format("  \"width\": {},\n  \"height\": {},\n", info.width,
+                      info.height);
+  file << fmt::format("  \"warmup_frames\": {},\n", info.warmup_frames);
+  file << fmt::format("  \"frames\": {},\n",
+                      values_.empty() ? 0 : values_.front().size());
+  file << fmt::format("  \"timestep_ms\": {},\n", info.timestep_ms);
+  file << "  \"metrics\": {";
+  for (std::size_t i = 0; i < metrics_.size(); ++i) {
+    const auto s = statistics(i);
+    file << fmt::format(
+        "{}\n    {}: {{\"mean\": {:.4f}, \"min\": {:.4f}, \"p50\": {:.4f}, "
+        "\"p95\": {:.4f}, \"p99\": {:.4f}, \"max\": {:.4f}}}",
+        i == 0 ? "" : ",", json_string(metrics_[i]), s.mean, s.min, s.p50,
+        s.p95, s.p99, s.max);
+  }
+  file << "\n  }\n}\n";
+  if (!file) {
+    throw std::runtime_error{fmt::format("Failed to write {}", path)};
+  }
+}
+
+void BenchmarkReport::write_csv(const std::string& path) const
+{
+  auto file = open_report(path);
+  file << "frame";
+  for (const auto& metric : metrics_) {
+    file << ',' << metric;
+  }
+  file << '\n';
+
+  const std::size_t frames = values_.empty() ? 0 : values_.front().size();
+  for (std::size_t frame = 0; frame < frames; ++frame) {
+    file << frame;
+    for (const auto& series : values_) {
+      file << fmt::format(",{:.4f}", series[frame]);
+    }
+    file << '\n';
+  }
+  if (!file) {
+    throw std::runtime_error{fmt::format("Failed to write {}", path)};
+  }
+}
@@ -0,0 +1,84 @@
+#ifndef GLGRASSRENDERER_BENCHMARK_HPP
+#define GLGRASSRENDERER_BENCHMARK_HPP
+
+#include "frame_stats.hpp"
+
+#include <glm/glm.hpp>
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct CameraKeyframe {
+  /// Seconds from the start of the path
+  float time = 0;
+  glm::vec3 position{0};
+  /// Degrees, as in Camera
+  float yaw = 0;
+  float pitch = 0;
+};
+
+/**
+ * @brief A camera flight through keyframes, for reproducible benchmarks
+ *
+ * Parsed from text with one keyframe per line: `time x y z yaw pitch`, with
+ * increasing times. Empty lines and lines starting with `#` are skipped. The
+ * camera moves linearly between keyframes and the path loops.
+ */
+class CameraPath {
+public:
+  /// Throws std::runtime_error naming the offending line
+  [[nodiscard]] static CameraPath parse(std::string_view text);
+
+  [[nodiscard]] CameraKeyframe sample(float time) const;
+
+  [[nodiscard]] float duration() const noexcept
+  {
+    return keyframes_.back().time;
+  }
+
+private:
+  std::vector<CameraKeyframe> keyframes_;
+};
+
+/// What a benchmark ran on and with, written alongside its results
+struct BenchmarkInfo {
+  std::string renderer;
+  std::string camera_path;
+  int width = 0;
+  int height = 0;
+  int warmup_frames = 0;
+  double timestep_ms = 0;
+};
+
+/**
+ * @brief Per-frame measurements of a benchmark run
+ *
+ * Every frame records one value per metric, in milliseconds. The JSON report
+ * holds the statistics of each metric, the CSV report every frame.
+ */
+class BenchmarkReport {
+public:
+  explicit BenchmarkReport(std::vector<std::string> metrics);
+
+  /// `values` holds one value per metric, in the order of the constructor
+  void add_frame(std::span<const double> values);
+
+  [[nodiscard]] const std::vector<std::string>& metrics() const noexcept
+  {
+    return metrics_;
+  }
+  [[nodiscard]] FrameStatistics statistics(std::size_t metric) const;
+
+  /// Throw std::runtime_error if the file cannot be written
+  void write_json(const std::string& path, const BenchmarkInfo& info) const;
+  void write_csv(const std::string& path) const;
+
+private:
+  std::vector<std::string> metrics_;
+  // One series per metric
+  std::vector<std::vector<double>> values_;
+};
+
+#endif // GLGRASSRENDERER_BENCHMARK_HPP
@@ -0,0 +1,79 @@
+#include "buffer_layout.hpp"
+
+#include <fmt/format.h>
+
+namespace {
+
+[[nodiscard]] GLint get_resource(GLuint program, GLenum interface,
+                                 GLuint index, GLenum property)
+{
+  GLint value = 0;
+  glGetProgramResourceiv(program, interface, index, 1, &property, 1, nullptr,
+                         &value);
+  return value;
+}
+
+} // anonymous namespace
+
+std::vector<std::string>
+find_layout_mismatches(GLuint program, const BufferBlockLayout& layout)
+{
+  std::vector<std::string> mismatches;
+
+  const std::string block_name{layout.name};
+  const GLuint block_index =
+      glGetProgramResourceIndex(program, layout.interface, block_name.c_str());
+  if (block_index == GL_INVALID_INDEX) {
+    mismatches.push_back(
+        fmt::format("{}: block not found in GLSL", layout.name));
+    return mismatches;
+  }
+
+  const auto binding =
+      get_resource(program, layout.interface, block_index, GL_BUFFER_BINDING);
+  if (binding != layout.binding) {
+    mismatches.push_back(fmt::format("{}: binding is {} in GLSL but {} in C++",
+                                     layout.name, binding, layout.binding));
+  }
+
+  // The GL size is the smallest buffer the block may be bound to, which
+  // the C++ struct may exceed but not fall short of
+  const auto size = static_cast<std::size_t>(get_resource(
+      program, layout.interface, block_index, GL_BUFFER_DATA_SIZE));
+  if (size > layout.size) {
+    mismatches.push_back(fmt::format("{}: size is {} in GLSL but {} in C++",
+                                     layout.name, size, layout.size));
+  }
+
+  const GLenum member_interface = layout.interface == GL_UNIFORM_BLOCK
+                                      ? GL_UNIFORM
+                                      : GL_BUFFER_VARIABLE;
+  for (const auto& member : layout.members) {
+    const auto name = fmt::format("{}{}", layout.member_prefix, member.name);
+    const GLuint index =
+        glGetProgramResourceIndex(program, member_interface, name.c_str());
+    if (index == GL_INVALID_INDEX) {
+      mismatches.push_back(fmt::format("{}: member not found in GLSL", name));
+      continue;
+    }
+
+    const auto offset = static_cast<std::size_t>(
+        get_resource(program, member_interface, index, GL_OFFSET));
+    if (offset != member.offset) {
+      mismatches.push_back(fmt::format("{}: offset is {} in GLSL but {} in C++",
+                                       name, offset, member.offset));
+    }
+
+    if (member_interface == GL_BUFFER_VARIABLE) {
+      const auto stride = static_cast<std::size_t>(get_resource(
+          program, member_interface, index, GL_TOP_LEVEL_ARRAY_STRIDE));
+      if (stride != layout.array_stride) {
+        mismatches.push_back(
+            fmt::format("{}: array stride is {} in GLSL but {} in C++", name,
+                        stride, layout.array_stride));
+      }
+    }
+  }
+
+  return mismatches;
+}
@@ -0,0 +1,46 @@
+#ifndef GLGRASSRENDERER_BUFFER_LAYOUT_HPP
+#define GLGRASSRENDERER_BUFFER_LAYOUT_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct BufferMemberLayout {
+  std::string_view name;
+  std::size_t offset;
+};
+
+/**
+ * @brief Compile-time description of how a C++ struct maps to a GLSL
+ * uniform or shader storage block
+ */
+struct BufferBlockLayout {
+  std::string_view name;
+  /// GL_UNIFORM_BLOCK or GL_SHADER_STORAGE_BLOCK
+  GLenum interface;
+  GLint binding;
+  /// Size of the C++ struct. For blocks ending in a runtime-sized array, the
+  /// size with one array element
+  std::size_t size;
+  /// Prepended to the member names to form the GL resource names, e.g.
+  /// "CameraBufferObject." or "inputBlades[0]."
+  std::string_view member_prefix;
+  /// Stride of the top-level array, 0 if the block is not an array
+  std::size_t array_stride;
+  std::span<const BufferMemberLayout> members;
+};
+
+/// Queries the program interface of a linked program and lists every
+/// difference from `layout`, including a block or member it cannot find.
+/// Every member stays active, referenced or not, in uniform blocks declared
+/// shared or std140 and in shader storage blocks declared shared, std140 or
+/// std430. The blocks checked must use those layouts and be declared in the
+/// program
+[[nodiscard]] std::vector<std::string>
+find_layout_mismatches(GLuint program, const BufferBlockLayout& layout);
+
+#endif // GLGRASSRENDERER_BUFFER_LAYOUT_HPP
@@ -67,6 +67,14 @@ void Camera::mouse_scroll(float yoffset)
   }
 }
 
+void Camera::set_pose(glm::vec3 position, float yaw, float pitch)
+{
+  position_ = position;
+  yam_ = yaw;
+  pitch_ = pitch;
+  update_camera_vectors();
+}
+
 void Camera::update_camera_vectors()
 {
   // Calculate the new Front vector
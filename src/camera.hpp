@@ -40,6 +40,9 @@ public:
 
   void mouse_scroll(float yoffset);
 
+  /// Places the camera, e.g. along a scripted path. Angles in degrees
+  void set_pose(glm::vec3 position, float yaw, float pitch);
+
   [[nodiscard]] float zoom() const
   {
     return zoom_;
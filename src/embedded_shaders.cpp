@@ -0,0 +1,25 @@
+#include "embedded_shaders.hpp"
+
+#include <algorithm>
+
+// With GLGRASS_EMBED_SHADERS, embedded_shaders() is defined in the source
+// generated by the shader_embed tool
+#ifndef GLGRASS_EMBED_SHADERS
+std::span<const EmbeddedShader> embedded_shaders() noexcept
+{
+  return {};
+}
+#endif
+
+std::optional<std::string_view>
+find_embedded_shader(std::string_view name) noexcept
+{
+  const auto shaders = embedded_shaders();
+  const auto it =
+      std::find_if(shaders.begin(), shaders.end(),
+                   [&](const EmbeddedShader& s) { return s.name == name; });
+  if (it == shaders.end()) {
+    return std::nullopt;
+  }
+  return it->source;
+}
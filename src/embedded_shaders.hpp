@@ -0,0 +1,20 @@
+#ifndef GLGRASSRENDERER_EMBEDDED_SHADERS_HPP
+#define GLGRASSRENDERER_EMBEDDED_SHADERS_HPP
+
+#include <optional>
+#include <span>
+#include <string_view>
+
+struct EmbeddedShader {
+  std::string_view name; // Relative to the data directory
+  std::string_view source;
+};
+
+/// Shader sources validated and embedded at build time. Empty unless the app
+/// is built with GLGRASS_EMBED_SHADERS
+[[nodiscard]] std::span<const EmbeddedShader> embedded_shaders() noexcept;
+
+[[nodiscard]] std::optional<std::string_view>
+find_embedded_shader(std::string_view name) noexcept;
+
+#endif // GLGRASSRENDERER_EMBEDDED_SHADERS_HPP
@@ -0,0 +1,51 @@
+#include "frame_pacer.hpp"
+#include "profiler.hpp"
+
+#include <chrono>
+
+FramePacer::FramePacer(std::size_t frames_in_flight)
+    : fences_(frames_in_flight, nullptr)
+{
+}
+
+FramePacer::~FramePacer()
+{
+  for (const GLsync fence : fences_) {
+    if (fence != nullptr) {
+      glDeleteSync(fence);
+    }
+  }
+}
+
+std::size_t FramePacer::begin_frame()
+{
+  if (started_) {
+    slot_ = (slot_ + 1) % fences_.size();
+  }
+  started_ = true;
+  wait_ms_ = 0;
+
+  GLsync& fence = fences_[slot_];
+  if (fence == nullptr) {
+    return slot_;
+  }
+  if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+    PROFILE_ZONE("wait_for_gpu");
+    ++stalls_;
+    const auto start = std::chrono::steady_clock::now();
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000) ==
+           GL_TIMEOUT_EXPIRED) {
+    }
+    wait_ms_ = std::chrono::duration<double, std::milli>{
+        std::chrono::steady_clock::now() - start}
+                   .count();
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+  return slot_;
+}
+
+void FramePacer::end_frame()
+{
+  fences_[slot_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,68 @@
+#ifndef GLGRASSRENDERER_FRAME_PACER_HPP
+#define GLGRASSRENDERER_FRAME_PACER_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Bounds how many frames the CPU submits ahead of the GPU
+ *
+ * Frames cycle through `frames_in_flight` slots, and each frame fences the
+ * commands it submitted. begin_frame() waits on the fence of the slot it
+ * reuses, so the CPU gets at most that many frames ahead, and the per-frame
+ * resources indexed by the slot are free to overwrite once it returns. More
+ * frames in flight keep the GPU busier, fewer make the input sampled at the
+ * start of a frame reach the screen sooner.
+ */
+class FramePacer {
+public:
+  static constexpr std::size_t max_frames_in_flight = 4;
+
+  /// `frames_in_flight` must lie in [1, max_frames_in_flight]
+  explicit FramePacer(std::size_t frames_in_flight);
+  ~FramePacer();
+
+  FramePacer(const FramePacer&) = delete;
+  FramePacer& operator=(const FramePacer&) = delete;
+  FramePacer(FramePacer&&) = delete;
+  FramePacer& operator=(FramePacer&&) = delete;
+
+  /// Moves to the next slot, waiting for the GPU to finish the frame that
+  /// last used it. Returns the slot
+  std::size_t begin_frame();
+  /// Fences the commands submitted since begin_frame()
+  void end_frame();
+
+  [[nodiscard]] std::size_t slot() const noexcept
+  {
+    return slot_;
+  }
+
+  [[nodiscard]] std::size_t frames_in_flight() const noexcept
+  {
+    return fences_.size();
+  }
+
+  /// How many times begin_frame() had to wait for the GPU
+  [[nodiscard]] std::size_t stalls() const noexcept
+  {
+    return stalls_;
+  }
+
+  /// The time the last begin_frame() waited, in milliseconds
+  [[nodiscard]] double wait_ms() const noexcept
+  {
+    return wait_ms_;
+  }
+
+private:
+  std::vector<GLsync> fences_;
+  std::size_t slot_ = 0;
+  bool started_ = false;
+  std::size_t stalls_ = 0;
+  double wait_ms_ = 0;
+};
+
+#endif // GLGRASSRENDERER_FRAME_PACER_HPP
@@ -0,0 +1,33 @@
+#include "frame_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+FrameStatistics summarize_frame_times(std::span<const double> milliseconds)
+{
+  if (milliseconds.empty()) {
+    return {};
+  }
+
+  std::vector<double> sorted(milliseconds.begin(), milliseconds.end());
+  std::sort(sorted.begin(), sorted.end());
+
+  const auto percentile = [&](double percent) {
+    const auto rank = static_cast<std::size_t>(
+        std::ceil(percent / 100 * static_cast<double>(sorted.size())));
+    return sorted[std::max(rank, std::size_t{1}) - 1];
+  };
+
+  FrameStatistics statistics;
+  statistics.frames = sorted.size();
+  statistics.total = std::accumulate(sorted.begin(), sorted.end(), 0.0);
+  statistics.mean = statistics.total / static_cast<double>(sorted.size());
+  statistics.min = sorted.front();
+  statistics.p50 = percentile(50);
+  statistics.p95 = percentile(95);
+  statistics.p99 = percentile(99);
+  statistics.max = sorted.back();
+  return statistics;
+}
@@ -0,0 +1,23 @@
+#ifndef GLGRASSRENDERER_FRAME_STATS_HPP
+#define GLGRASSRENDERER_FRAME_STATS_HPP
+
+#include <cstddef>
+#include <span>
+
+/// Summary of a series of frame times, in milliseconds. Percentiles use the
+/// nearest-rank method, so they are always one of the measured times
+struct FrameStatistics {
+  std::size_t frames = 0;
+  double total = 0;
+  double mean = 0;
+  double min = 0;
+  double p50 = 0;
+  double p95 = 0;
+  double p99 = 0;
+  double max = 0;
+};
+
+[[nodiscard]] FrameStatistics
+summarize_frame_times(std::span<const double> milliseconds);
+
+#endif // GLGRASSRENDERER_FRAME_STATS_HPP
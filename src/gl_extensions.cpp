@@ -0,0 +1,134 @@
+#include "gl_extensions.hpp"
+
+#include <string_view>
+
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC ext_glMaxShaderCompilerThreadsKHR =
+    nullptr;
+PFNGLCREATEBUFFERSPROC ext_glCreateBuffers = nullptr;
+PFNGLNAMEDBUFFERSTORAGEPROC ext_glNamedBufferStorage = nullptr;
+PFNGLNAMEDBUFFERSUBDATAPROC ext_glNamedBufferSubData = nullptr;
+PFNGLMAPNAMEDBUFFERRANGEPROC ext_glMapNamedBufferRange = nullptr;
+PFNGLUNMAPNAMEDBUFFERPROC ext_glUnmapNamedBuffer = nullptr;
+PFNGLCLEARNAMEDBUFFERSUBDATAPROC ext_glClearNamedBufferSubData = nullptr;
+PFNGLCOPYNAMEDBUFFERSUBDATAPROC ext_glCopyNamedBufferSubData = nullptr;
+PFNGLCREATEVERTEXARRAYSPROC ext_glCreateVertexArrays = nullptr;
+PFNGLVERTEXARRAYVERTEXBUFFERPROC ext_glVertexArrayVertexBuffer = nullptr;
+PFNGLVERTEXARRAYATTRIBFORMATPROC ext_glVertexArrayAttribFormat = nullptr;
+PFNGLVERTEXARRAYATTRIBBINDINGPROC ext_glVertexArrayAttribBinding = nullptr;
+PFNGLENABLEVERTEXARRAYATTRIBPROC ext_glEnableVertexArrayAttrib = nullptr;
+PFNGLCREATETEXTURESPROC ext_glCreateTextures = nullptr;
+PFNGLTEXTURESTORAGE2DPROC ext_glTextureStorage2D = nullptr;
+PFNGLTEXTURESTORAGE3DPROC ext_glTextureStorage3D = nullptr;
+PFNGLTEXTURESUBIMAGE2DPROC ext_glTextureSubImage2D = nullptr;
+PFNGLTEXTURESUBIMAGE3DPROC ext_glTextureSubImage3D = nullptr;
+PFNGLCOMPRESSEDTEXTURESUBIMAGE2DPROC ext_glCompressedTextureSubImage2D =
+    nullptr;
+PFNGLCOMPRESSEDTEXTURESUBIMAGE3DPROC ext_glCompressedTextureSubImage3D =
+    nullptr;
+PFNGLTEXTUREPARAMETERIPROC ext_glTextureParameteri = nullptr;
+PFNGLGENERATETEXTUREMIPMAPPROC ext_glGenerateTextureMipmap = nullptr;
+PFNGLBINDTEXTUREUNITPROC ext_glBindTextureUnit = nullptr;
+PFNGLCREATESAMPLERSPROC ext_glCreateSamplers = nullptr;
+
+namespace {
+
+GLExtensions extensions;
+
+[[nodiscard]] bool has_extension(std::string_view name)
+{
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; ++i) {
+    const auto* ext = reinterpret_cast<const char*>(
+        glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+    if (ext != nullptr && name == ext) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename Proc> Proc load_proc(GLADloadproc load, const char* name)
+{
+  return reinterpret_cast<Proc>(load(name));
+}
+
+/// Loads `proc` and returns whether the driver has it
+template <typename Proc>
+bool load_proc(Proc& proc, GLADloadproc load, const char* name)
+{
+  proc = load_proc<Proc>(load, name);
+  return proc != nullptr;
+}
+
+[[nodiscard]] bool load_direct_state_access(GLADloadproc load)
+{
+  bool loaded = true;
+  loaded &= load_proc(ext_glCreateBuffers, load, "glCreateBuffers");
+  loaded &= load_proc(ext_glNamedBufferStorage, load, "glNamedBufferStorage");
+  loaded &= load_proc(ext_glNamedBufferSubData, load, "glNamedBufferSubData");
+  loaded &= load_proc(ext_glMapNamedBufferRange, load,
+                      "glMapNamedBufferRange");
+  loaded &= load_proc(ext_glUnmapNamedBuffer, load, "glUnmapNamedBuffer");
+  loaded &= load_proc(ext_glClearNamedBufferSubData, load,
+                      "glClearNamedBufferSubData");
+  loaded &= load_proc(ext_glCopyNamedBufferSubData, load,
+                      "glCopyNamedBufferSubData");
+  loaded &= load_proc(ext_glCreateVertexArrays, load, "glCreateVertexArrays");
+  loaded &= load_proc(ext_glVertexArrayVertexBuffer, load,
+                      "glVertexArrayVertexBuffer");
+  loaded &= load_proc(ext_glVertexArrayAttribFormat, load,
+                      "glVertexArrayAttribFormat");
+  loaded &= load_proc(ext_glVertexArrayAttribBinding, load,
+                      "glVertexArrayAttribBinding");
+  loaded &= load_proc(ext_glEnableVertexArrayAttrib, load,
+                      "glEnableVertexArrayAttrib");
+  loaded &= load_proc(ext_glCreateTextures, load, "glCreateTextures");
+  loaded &= load_proc(ext_glTextureStorage2D, load, "glTextureStorage2D");
+  loaded &= load_proc(ext_glTextureStorage3D, load, "glTextureStorage3D");
+  loaded &= load_proc(ext_glTextureSubImage2D, load, "glTextureSubImage2D");
+  loaded &= load_proc(ext_glTextureSubImage3D, load, "glTextureSubImage3D");
+  loaded &= load_proc(ext_glCompressedTextureSubImage2D, load,
+                      "glCompressedTextureSubImage2D");
+  loaded &= load_proc(ext_glCompressedTextureSubImage3D, load,
+                      "glCompressedTextureSubImage3D");
+  loaded &= load_proc(ext_glTextureParameteri, load, "glTextureParameteri");
+  loaded &= load_proc(ext_glGenerateTextureMipmap, load,
+                      "glGenerateTextureMipmap");
+  loaded &= load_proc(ext_glBindTextureUnit, load, "glBindTextureUnit");
+  loaded &= load_proc(ext_glCreateSamplers, load, "glCreateSamplers");
+  return loaded;
+}
+
+} // anonymous namespace
+
+void load_gl_extensions(GLADloadproc load)
+{
+  if (has_extension("GL_KHR_parallel_shader_compile")) {
+    ext_glMaxShaderCompilerThreadsKHR =
+        load_proc<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(
+            load, "glMaxShaderCompilerThreadsKHR");
+  } else if (has_extension("GL_ARB_parallel_shader_compile")) {
+    ext_glMaxShaderCompilerThreadsKHR =
+        load_proc<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(
+            load, "glMaxShaderCompilerThreadsARB");
+  }
+  extensions.parallel_shader_compile =
+      ext_glMaxShaderCompilerThreadsKHR != nullptr;
+
+  extensions.direct_state_access =
+      (GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 5) ||
+       has_extension("GL_ARB_direct_state_access")) &&
+      load_direct_state_access(load);
+
+  extensions.texture_compression_s3tc =
+      has_extension("GL_EXT_texture_compression_s3tc");
+  extensions.pipeline_statistics_query =
+      GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 6) ||
+      has_extension("GL_ARB_pipeline_statistics_query");
+}
+
+const GLExtensions& gl_extensions() noexcept
+{
+  return extensions;
+}
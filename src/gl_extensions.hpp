@@ -0,0 +1,175 @@
+#ifndef GLGRASSRENDERER_GL_EXTENSIONS_HPP
+#define GLGRASSRENDERER_GL_EXTENSIONS_HPP
+
+#include <glad/glad.h>
+
+// Our glad loader only covers the OpenGL 4.3 core API. Everything newer that
+// the renderer takes advantage of is declared here and loaded at runtime by
+// load_gl_extensions(). The entry points stay null when the driver does not
+// expose them, so check gl_extensions() before calling.
+
+// GL_KHR_parallel_shader_compile / GL_ARB_parallel_shader_compile
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void(APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC ext_glMaxShaderCompilerThreadsKHR;
+#define glMaxShaderCompilerThreadsKHR ext_glMaxShaderCompilerThreadsKHR
+
+// OpenGL 4.4 / GL_ARB_buffer_storage
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+// OpenGL 4.5 / GL_ARB_direct_state_access. Only the entry points the
+// renderer uses are declared
+typedef void(APIENTRYP PFNGLCREATEBUFFERSPROC)(GLsizei n, GLuint* buffers);
+typedef void(APIENTRYP PFNGLNAMEDBUFFERSTORAGEPROC)(GLuint buffer,
+                                                    GLsizeiptr size,
+                                                    const void* data,
+                                                    GLbitfield flags);
+typedef void(APIENTRYP PFNGLNAMEDBUFFERSUBDATAPROC)(GLuint buffer,
+                                                    GLintptr offset,
+                                                    GLsizeiptr size,
+                                                    const void* data);
+typedef void*(APIENTRYP PFNGLMAPNAMEDBUFFERRANGEPROC)(GLuint buffer,
+                                                      GLintptr offset,
+                                                      GLsizeiptr length,
+                                                      GLbitfield access);
+typedef GLboolean(APIENTRYP PFNGLUNMAPNAMEDBUFFERPROC)(GLuint buffer);
+typedef void(APIENTRYP PFNGLCLEARNAMEDBUFFERSUBDATAPROC)(
+    GLuint buffer, GLenum internalformat, GLintptr offset, GLsizeiptr size,
+    GLenum format, GLenum type, const void* data);
+typedef void(APIENTRYP PFNGLCOPYNAMEDBUFFERSUBDATAPROC)(
+    GLuint readBuffer, GLuint writeBuffer, GLintptr readOffset,
+    GLintptr writeOffset, GLsizeiptr size);
+typedef void(APIENTRYP PFNGLCREATEVERTEXARRAYSPROC)(GLsizei n,
+                                                    GLuint* arrays);
+typedef void(APIENTRYP PFNGLVERTEXARRAYVERTEXBUFFERPROC)(GLuint vaobj,
+                                                         GLuint bindingindex,
+                                                         GLuint buffer,
+                                                         GLintptr offset,
+                                                         GLsizei stride);
+typedef void(APIENTRYP PFNGLVERTEXARRAYATTRIBFORMATPROC)(
+    GLuint vaobj, GLuint attribindex, GLint size, GLenum type,
+    GLboolean normalized, GLuint relativeoffset);
+typedef void(APIENTRYP PFNGLVERTEXARRAYATTRIBBINDINGPROC)(GLuint vaobj,
+                                                          GLuint attribindex,
+                                                          GLuint bindingindex);
+typedef void(APIENTRYP PFNGLENABLEVERTEXARRAYATTRIBPROC)(GLuint vaobj,
+                                                         GLuint index);
+typedef void(APIENTRYP PFNGLCREATETEXTURESPROC)(GLenum target, GLsizei n,
+                                                GLuint* textures);
+typedef void(APIENTRYP PFNGLTEXTURESTORAGE2DPROC)(GLuint texture,
+                                                  GLsizei levels,
+                                                  GLenum internalformat,
+                                                  GLsizei width,
+                                                  GLsizei height);
+typedef void(APIENTRYP PFNGLTEXTURESTORAGE3DPROC)(
+    GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width,
+    GLsizei height, GLsizei depth);
+typedef void(APIENTRYP PFNGLTEXTURESUBIMAGE2DPROC)(
+    GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width,
+    GLsizei height, GLenum format, GLenum type, const void* pixels);
+typedef void(APIENTRYP PFNGLTEXTURESUBIMAGE3DPROC)(
+    GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLint zoffset,
+    GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type,
+    const void* pixels);
+typedef void(APIENTRYP PFNGLCOMPRESSEDTEXTURESUBIMAGE2DPROC)(
+    GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width,
+    GLsizei height, GLenum format, GLsizei imageSize, const void* data);
+typedef void(APIENTRYP PFNGLCOMPRESSEDTEXTURESUBIMAGE3DPROC)(
+    GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLint zoffset,
+    GLsizei width, GLsizei height, GLsizei depth, GLenum format,
+    GLsizei imageSize, const void* data);
+typedef void(APIENTRYP PFNGLTEXTUREPARAMETERIPROC)(GLuint texture,
+                                                   GLenum pname, GLint param);
+typedef void(APIENTRYP PFNGLGENERATETEXTUREMIPMAPPROC)(GLuint texture);
+typedef void(APIENTRYP PFNGLBINDTEXTUREUNITPROC)(GLuint unit, GLuint texture);
+typedef void(APIENTRYP PFNGLCREATESAMPLERSPROC)(GLsizei n, GLuint* samplers);
+
+extern PFNGLCREATEBUFFERSPROC ext_glCreateBuffers;
+extern PFNGLNAMEDBUFFERSTORAGEPROC ext_glNamedBufferStorage;
+extern PFNGLNAMEDBUFFERSUBDATAPROC ext_glNamedBufferSubData;
+extern PFNGLMAPNAMEDBUFFERRANGEPROC ext_glMapNamedBufferRange;
+extern PFNGLUNMAPNAMEDBUFFERPROC ext_glUnmapNamedBuffer;
+extern PFNGLCLEARNAMEDBUFFERSUBDATAPROC ext_glClearNamedBufferSubData;
+extern PFNGLCOPYNAMEDBUFFERSUBDATAPROC ext_glCopyNamedBufferSubData;
+extern PFNGLCREATEVERTEXARRAYSPROC ext_glCreateVertexArrays;
+extern PFNGLVERTEXARRAYVERTEXBUFFERPROC ext_glVertexArrayVertexBuffer;
+extern PFNGLVERTEXARRAYATTRIBFORMATPROC ext_glVertexArrayAttribFormat;
+extern PFNGLVERTEXARRAYATTRIBBINDINGPROC ext_glVertexArrayAttribBinding;
+extern PFNGLENABLEVERTEXARRAYATTRIBPROC ext_glEnableVertexArrayAttrib;
+extern PFNGLCREATETEXTURESPROC ext_glCreateTextures;
+extern PFNGLTEXTURESTORAGE2DPROC ext_glTextureStorage2D;
+extern PFNGLTEXTURESTORAGE3DPROC ext_glTextureStorage3D;
+extern PFNGLTEXTURESUBIMAGE2DPROC ext_glTextureSubImage2D;
+extern PFNGLTEXTURESUBIMAGE3DPROC ext_glTextureSubImage3D;
+extern PFNGLCOMPRESSEDTEXTURESUBIMAGE2DPROC ext_glCompressedTextureSubImage2D;
+extern PFNGLCOMPRESSEDTEXTURESUBIMAGE3DPROC ext_glCompressedTextureSubImage3D;
+extern PFNGLTEXTUREPARAMETERIPROC ext_glTextureParameteri;
+extern PFNGLGENERATETEXTUREMIPMAPPROC ext_glGenerateTextureMipmap;
+extern PFNGLBINDTEXTUREUNITPROC ext_glBindTextureUnit;
+extern PFNGLCREATESAMPLERSPROC ext_glCreateSamplers;
+#define glCreateBuffers ext_glCreateBuffers
+#define glNamedBufferStorage ext_glNamedBufferStorage
+#define glNamedBufferSubData ext_glNamedBufferSubData
+#define glMapNamedBufferRange ext_glMapNamedBufferRange
+#define glUnmapNamedBuffer ext_glUnmapNamedBuffer
+#define glClearNamedBufferSubData ext_glClearNamedBufferSubData
+#define glCopyNamedBufferSubData ext_glCopyNamedBufferSubData
+#define glCreateVertexArrays ext_glCreateVertexArrays
+#define glVertexArrayVertexBuffer ext_glVertexArrayVertexBuffer
+#define glVertexArrayAttribFormat ext_glVertexArrayAttribFormat
+#define glVertexArrayAttribBinding ext_glVertexArrayAttribBinding
+#define glEnableVertexArrayAttrib ext_glEnableVertexArrayAttrib
+#define glCreateTextures ext_glCreateTextures
+#define glTextureStorage2D ext_glTextureStorage2D
+#define glTextureStorage3D ext_glTextureStorage3D
+#define glTextureSubImage2D ext_glTextureSubImage2D
+#define glTextureSubImage3D ext_glTextureSubImage3D
+#define glCompressedTextureSubImage2D ext_glCompressedTextureSubImage2D
+#define glCompressedTextureSubImage3D ext_glCompressedTextureSubImage3D
+#define glTextureParameteri ext_glTextureParameteri
+#define glGenerateTextureMipmap ext_glGenerateTextureMipmap
+#define glBindTextureUnit ext_glBindTextureUnit
+#define glCreateSamplers ext_glCreateSamplers
+
+// GL_EXT_texture_compression_s3tc, available on every desktop driver but never
+// promoted to core
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+// OpenGL 4.6 / GL_ARB_pipeline_statistics_query. Only adds query targets
+#ifndef GL_VERTEX_SHADER_INVOCATIONS_ARB
+#define GL_VERTEX_SHADER_INVOCATIONS_ARB 0x82F0
+#define GL_TESS_CONTROL_SHADER_PATCHES_ARB 0x82F1
+#define GL_TESS_EVALUATION_SHADER_INVOCATIONS_ARB 0x82F2
+#define GL_FRAGMENT_SHADER_INVOCATIONS_ARB 0x82F4
+#define GL_COMPUTE_SHADER_INVOCATIONS_ARB 0x82F5
+#define GL_CLIPPING_INPUT_PRIMITIVES_ARB 0x82F6
+#define GL_CLIPPING_OUTPUT_PRIMITIVES_ARB 0x82F7
+#endif
+
+struct GLExtensions {
+  bool parallel_shader_compile = false;
+  /// Every entry point of the renderer's GPU resource layer, see gl_objects.hpp
+  bool direct_state_access = false;
+  bool texture_compression_s3tc = false;
+  bool pipeline_statistics_query = false;
+};
+
+/// Loads the entry points above. Must be called after glad is initialized
+void load_gl_extensions(GLADloadproc load);
+
+[[nodiscard]] const GLExtensions& gl_extensions() noexcept;
+
+#endif // GLGRASSRENDERER_GL_EXTENSIONS_HPP
@@ -0,0 +1,106 @@
+#include "gl_objects.hpp"
+#include "gl_extensions.hpp"
+#include "gl_state.hpp"
+
+#include <utility>
+
+Buffer::Buffer(GLsizeiptr size, const void* data, GLbitfield flags)
+    : size_{size}
+{
+  glCreateBuffers(1, &id_);
+  glNamedBufferStorage(id_, size, data, flags);
+}
+
+Buffer::~Buffer()
+{
+  gl_state().forget_buffer(id_);
+  glDeleteBuffers(1, &id_);
+}
+
+void Buffer::update(GLintptr offset, GLsizeiptr size, const void* data)
+{
+  glNamedBufferSubData(id_, offset, size, data);
+}
+
+VertexArray::VertexArray()
+{
+  glCreateVertexArrays(1, &id_);
+}
+
+VertexArray::~VertexArray()
+{
+  gl_state().forget_vertex_array(id_);
+  glDeleteVertexArrays(1, &id_);
+}
+
+void VertexArray::vertex_buffer(GLuint binding, const Buffer& buffer,
+                                GLintptr offset, GLsizei stride)
+{
+  glVertexArrayVertexBuffer(id_, binding, buffer.id(), offset, stride);
+}
+
+void VertexArray::attribute(GLuint index, GLuint binding, GLint size,
+                            GLenum type, GLuint offset)
+{
+  glEnableVertexArrayAttrib(id_, index);
+  glVertexArrayAttribFormat(id_, index, size, type, GL_FALSE, offset);
+  glVertexArrayAttribBinding(id_, index, binding);
+}
+
+void VertexArray::bind() const
+{
+  gl_state().bind_vertex_array(id_);
+}
+
+Texture::Texture(GLenum target)
+{
+  glCreateTextures(target, 1, &id_);
+}
+
+Texture::~Texture()
+{
+  gl_state().forget_texture(id_);
+  glDeleteTextures(1, &id_);
+}
+
+Texture::Texture(Texture&& other) noexcept
+    : id_{std::exchange(other.id_, 0)}
+{
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+  std::swap(id_, other.id_);
+  return *this;
+}
+
+void Texture::parameter(GLenum name, GLint value)
+{
+  glTextureParameteri(id_, name, value);
+}
+
+void Texture::bind(GLuint unit) const
+{
+  gl_state().bind_texture_unit(unit, id_);
+}
+
+Sampler::Sampler()
+{
+  glCreateSamplers(1, &id_);
+}
+
+Sampler::~Sampler()
+{
+  gl_state().forget_sampler(id_);
+  glDeleteSamplers(1, &id_);
+}
+
+void Sampler::parameter(GLenum name, GLint value)
+{
+  glSamplerParameteri(id_, name, value);
+}
+
+void Sampler::bind(GLuint unit) const
+{
+  gl_state().bind_sampler(unit, id_);
+}
@@ -0,0 +1,113 @@
+#ifndef GLGRASSRENDERER_GL_OBJECTS_HPP
+#define GLGRASSRENDERER_GL_OBJECTS_HPP
+
+#include <glad/glad.h>
+
+// Thin owners of GL objects, created and edited through direct state access:
+// none of them depends on, or changes, what is bound to the context. They need
+// gl_extensions().direct_state_access
+
+/// A buffer object with immutable storage, deleted with its owner
+class Buffer {
+public:
+  /// `flags` are glBufferStorage() flags. Buffers written after creation
+  /// with update() need GL_DYNAMIC_STORAGE_BIT
+  Buffer(GLsizeiptr size, const void* data, GLbitfield flags);
+  ~Buffer();
+
+  Buffer(const Buffer&) = delete;
+  Buffer& operator=(const Buffer&) = delete;
+  Buffer(Buffer&&) = delete;
+  Buffer& operator=(Buffer&&) = delete;
+
+  void update(GLintptr offset, GLsizeiptr size, const void* data);
+
+  [[nodiscard]] GLuint id() const noexcept
+  {
+    return id_;
+  }
+
+  [[nodiscard]] GLsizeiptr size() const noexcept
+  {
+    return size_;
+  }
+
+private:
+  GLuint id_ = 0;
+  GLsizeiptr size_ = 0;
+};
+
+/// A vertex array object. Its vertex buffers are referenced, not owned
+class VertexArray {
+public:
+  VertexArray();
+  ~VertexArray();
+
+  VertexArray(const VertexArray&) = delete;
+  VertexArray& operator=(const VertexArray&) = delete;
+  VertexArray(VertexArray&&) = delete;
+  VertexArray& operator=(VertexArray&&) = delete;
+
+  /// Reads the vertices of `binding` from `buffer`
+  void vertex_buffer(GLuint binding, const Buffer& buffer, GLintptr offset,
+                     GLsizei stride);
+  /// Enables float attribute `index` with `size` components of `type`, read
+  /// at `offset` in the vertices of `binding`
+  void attribute(GLuint index, GLuint binding, GLint size, GLenum type,
+                 GLuint offset);
+
+  void bind() const;
+
+private:
+  GLuint id_ = 0;
+};
+
+/// A texture object, deleted with its owner. Default constructed, it holds
+/// no texture and has id 0
+class Texture {
+public:
+  Texture() = default;
+  explicit Texture(GLenum target);
+  ~Texture();
+
+  Texture(const Texture&) = delete;
+  Texture& operator=(const Texture&) = delete;
+  Texture(Texture&& other) noexcept;
+  Texture& operator=(Texture&& other) noexcept;
+
+  /// Sets a sampling parameter of the texture itself. Sampler objects bound
+  /// to the same unit take precedence
+  void parameter(GLenum name, GLint value);
+
+  void bind(GLuint unit) const;
+
+  [[nodiscard]] GLuint id() const noexcept
+  {
+    return id_;
+  }
+
+private:
+  GLuint id_ = 0;
+};
+
+/// A sampler object, whose state overrides that of the textures bound to the
+/// same units
+class Sampler {
+public:
+  Sampler();
+  ~Sampler();
+
+  Sampler(const Sampler&) = delete;
+  Sampler& operator=(const Sampler&) = delete;
+  Sampler(Sampler&&) = delete;
+  Sampler& operator=(Sampler&&) = delete;
+
+  void parameter(GLenum name, GLint value);
+
+  void bind(GLuint unit) const;
+
+private:
+  GLuint id_ = 0;
+};
+
+#endif // GLGRASSRENDERER_GL_OBJECTS_HPP
@@ -0,0 +1,169 @@
+#include "gl_state.hpp"
+#include "gl_extensions.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+GLState state;
+
+} // anonymous namespace
+
+bool GLState::count(bool issued) noexcept
+{
+  ++(issued ? counters_.issued : counters_.elided);
+  return issued;
+}
+
+bool GLState::change(GLuint& current, GLuint value)
+{
+  const bool changed = current != value;
+  current = value;
+  return count(changed);
+}
+
+GLuint& GLState::generic_binding(GLenum target)
+{
+  const auto binding =
+      std::ranges::find(buffers_, target, &BufferBinding::target);
+  if (binding != buffers_.end()) {
+    return binding->buffer;
+  }
+  buffers_.push_back({target, unknown});
+  return buffers_.back().buffer;
+}
+
+GLState::IndexedBufferBinding& GLState::indexed_binding(GLenum target,
+                                                        GLuint index)
+{
+  const auto binding = std::ranges::find_if(
+      indexed_buffers_, [&](const IndexedBufferBinding& candidate) {
+        return candidate.target == target && candidate.index == index;
+      });
+  if (binding != indexed_buffers_.end()) {
+    return *binding;
+  }
+  indexed_buffers_.push_back({target, index, unknown, 0, 0});
+  return indexed_buffers_.back();
+}
+
+void GLState::use_program(GLuint program)
+{
+  if (change(program_, program)) {
+    glUseProgram(program);
+  }
+}
+
+void GLState::bind_vertex_array(GLuint vertex_array)
+{
+  if (change(vertex_array_, vertex_array)) {
+    glBindVertexArray(vertex_array);
+  }
+}
+
+void GLState::bind_texture_unit(GLuint unit, GLuint texture)
+{
+  if (unit >= tracked_units ? count(true) : change(textures_[unit], texture)) {
+    glBindTextureUnit(unit, texture);
+  }
+}
+
+void GLState::bind_sampler(GLuint unit, GLuint sampler)
+{
+  if (unit >= tracked_units ? count(true) : change(samplers_[unit], sampler)) {
+    glBindSampler(unit, sampler);
+  }
+}
+
+void GLState::bind_buffer(GLenum target, GLuint buffer)
+{
+  if (change(generic_binding(target), buffer)) {
+    glBindBuffer(target, buffer);
+  }
+}
+
+void GLState::bind_buffer_base(GLenum target, GLuint index, GLuint buffer)
+{
+  bind_buffer_range(target, index, buffer, 0, 0);
+}
+
+// Indexed binds also bind the generic target, so the call is elided only when
+// both bindings already match
+void GLState::bind_buffer_range(GLenum target, GLuint index, GLuint buffer,
+                                GLintptr offset, GLsizeiptr size)
+{
+  GLuint& generic = generic_binding(target);
+  IndexedBufferBinding& binding = indexed_binding(target, index);
+  const bool changed = generic != buffer || binding.buffer != buffer ||
+                       binding.offset != offset || binding.size != size;
+  generic = buffer;
+  binding = {target, index, buffer, offset, size};
+  if (!count(changed)) {
+    return;
+  }
+
+  if (size == 0) {
+    glBindBufferBase(target, index, buffer);
+  } else {
+    glBindBufferRange(target, index, buffer, offset, size);
+  }
+}
+
+void GLState::forget_program(GLuint program)
+{
+  if (program_ == program) {
+    program_ = unknown;
+  }
+}
+
+void GLState::forget_vertex_array(GLuint vertex_array)
+{
+  if (vertex_array_ == vertex_array) {
+    vertex_array_ = unknown;
+  }
+}
+
+void GLState::forget_texture(GLuint texture)
+{
+  std::ranges::replace(textures_, texture, unknown);
+}
+
+void GLState::forget_sampler(GLuint sampler)
+{
+  std::ranges::replace(samplers_, sampler, unknown);
+}
+
+void GLState::forget_buffer(GLuint buffer)
+{
+  for (BufferBinding& binding : buffers_) {
+    if (binding.buffer == buffer) {
+      binding.buffer = unknown;
+    }
+  }
+  for (IndexedBufferBinding& binding : indexed_buffers_) {
+    if (binding.buffer == buffer) {
+      binding.buffer = unknown;
+    }
+  }
+}
+
+void GLState::invalidate()
+{
+  program_ = unknown;
+  vertex_array_ = unknown;
+  textures_.fill(unknown);
+  samplers_.fill(unknown);
+  buffers_.clear();
+  indexed_buffers_.clear();
+}
+
+GLState::Counters GLState::take_counters() noexcept
+{
+  return std::exchange(counters_, Counters{});
+}
+
+GLState& gl_state() noexcept
+{
+  return state;
+}
@@ -0,0 +1,89 @@
+#ifndef GLGRASSRENDERER_GL_STATE_HPP
+#define GLGRASSRENDERER_GL_STATE_HPP
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Mirrors the bindings of the context and skips the calls that would
+ * not change them
+ *
+ * Every program switch, vertex array, texture unit, sampler and buffer
+ * binding of the renderer goes through the tracker. Code that changes these
+ * bindings behind its back must call invalidate() afterwards. Dear ImGui's
+ * backend restores everything it binds, so it needs not.
+ */
+class GLState {
+public:
+  struct Counters {
+    std::size_t issued = 0;
+    std::size_t elided = 0;
+  };
+
+  void use_program(GLuint program);
+  void bind_vertex_array(GLuint vertex_array);
+  void bind_texture_unit(GLuint unit, GLuint texture);
+  void bind_sampler(GLuint unit, GLuint sampler);
+  void bind_buffer(GLenum target, GLuint buffer);
+  void bind_buffer_base(GLenum target, GLuint index, GLuint buffer);
+  void bind_buffer_range(GLenum target, GLuint index, GLuint buffer,
+                         GLintptr offset, GLsizeiptr size);
+
+  // Called before an object is deleted, whose name the driver may then hand
+  // out again
+  void forget_program(GLuint program);
+  void forget_vertex_array(GLuint vertex_array);
+  void forget_texture(GLuint texture);
+  void forget_sampler(GLuint sampler);
+  void forget_buffer(GLuint buffer);
+
+  /// Forgets every binding, the next call of each kind is issued
+  void invalidate();
+
+  /// The calls issued and elided since the last call
+  [[nodiscard]] Counters take_counters() noexcept;
+
+private:
+  /// Never a GL name, so that nothing matches it
+  static constexpr GLuint unknown = ~GLuint{0};
+  /// Texture and sampler units tracked, binds to later units are issued
+  static constexpr std::size_t tracked_units = 32;
+
+  struct BufferBinding {
+    GLenum target;
+    GLuint buffer;
+  };
+
+  struct IndexedBufferBinding {
+    GLenum target;
+    GLuint index;
+    GLuint buffer;
+    GLintptr offset;
+    /// 0 for glBindBufferBase()
+    GLsizeiptr size;
+  };
+
+  GLuint program_ = 0;
+  GLuint vertex_array_ = 0;
+  std::array<GLuint, tracked_units> textures_{};
+  std::array<GLuint, tracked_units> samplers_{};
+  std::vector<BufferBinding> buffers_;
+  std::vector<IndexedBufferBinding> indexed_buffers_;
+  Counters counters_;
+
+  /// Counts a call as issued or elided, and returns `issued`
+  bool count(bool issued) noexcept;
+  /// Records `value` as current, and returns whether the call must be issued
+  [[nodiscard]] bool change(GLuint& current, GLuint value);
+  [[nodiscard]] GLuint& generic_binding(GLenum target);
+  [[nodiscard]] IndexedBufferBinding& indexed_binding(GLenum target,
+                                                      GLuint index);
+};
+
+/// The tracker of the current context
+[[nodiscard]] GLState& gl_state() noexcept;
+
+#endif // GLGRASSRENDERER_GL_STATE_HPP
@@ -0,0 +1,119 @@
+#include "gpu_timer.hpp"
+
+#include <iterator>
+#include <numeric>
+
+GpuTimer::GpuTimer(std::vector<std::string> pass_names,
+                   std::size_t frames_in_flight)
+    : pass_names_{std::move(pass_names)}, ring_(frames_in_flight)
+{
+  for (auto& slot : ring_) {
+    slot.queries.resize(2 * pass_names_.size());
+    slot.recorded.resize(pass_names_.size());
+    glGenQueries(static_cast<GLsizei>(slot.queries.size()),
+                 slot.queries.data());
+  }
+}
+
+GpuTimer::~GpuTimer()
+{
+  for (auto& slot : ring_) {
+    glDeleteQueries(static_cast<GLsizei>(slot.queries.size()),
+                    slot.queries.data());
+  }
+}
+
+void GpuTimer::begin_frame(std::size_t frame_slot)
+{
+  if (recording_) {
+    ++frame_;
+  }
+  recording_ = true;
+  current_ = frame_slot;
+
+  Slot& slot = ring_[current_];
+  resolve(slot, false);
+  slot.frame = frame_;
+  slot.recorded.assign(slot.recorded.size(), false);
+  slot.last_query = 0;
+}
+
+void GpuTimer::begin(std::size_t pass)
+{
+  Slot& slot = ring_[current_];
+  glQueryCounter(slot.queries[2 * pass], GL_TIMESTAMP);
+}
+
+void GpuTimer::end(std::size_t pass)
+{
+  Slot& slot = ring_[current_];
+  glQueryCounter(slot.queries[2 * pass + 1], GL_TIMESTAMP);
+  slot.recorded[pass] = true;
+  slot.last_query = slot.queries[2 * pass + 1];
+  slot.pending = true;
+}
+
+void GpuTimer::flush()
+{
+  // Oldest first, so that the frames are resolved in order
+  for (std::size_t i = 1; i <= ring_.size(); ++i) {
+    resolve(ring_[(current_ + i) % ring_.size()], true);
+  }
+}
+
+std::vector<GpuTimer::FrameTimes> GpuTimer::take_resolved()
+{
+  std::vector<FrameTimes> resolved(std::make_move_iterator(resolved_.begin()),
+                                   std::make_move_iterator(resolved_.end()));
+  resolved_.clear();
+  return resolved;
+}
+
+double GpuTimer::average(std::size_t pass) const
+{
+  if (history_.empty()) {
+    return 0;
+  }
+  const double sum = std::accumulate(
+      history_.begin(), history_.end(), 0.0,
+      [&](double total, const auto& frame) { return total + frame[pass]; });
+  return sum / static_cast<double>(history_.size());
+}
+
+void GpuTimer::resolve(Slot& slot, bool wait)
+{
+  if (!slot.pending) {
+    return;
+  }
+  slot.pending = false;
+
+  if (!wait) {
+    GLint available = 0;
+    glGetQueryObjectiv(slot.last_query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == 0) {
+      ++dropped_frames_;
+      return;
+    }
+  }
+
+  FrameTimes times{slot.frame, std::vector<double>(pass_names_.size())};
+  for (std::size_t pass = 0; pass < pass_names_.size(); ++pass) {
+    if (!slot.recorded[pass]) {
+      continue;
+    }
+    GLuint64 begin = 0;
+    GLuint64 end = 0;
+    glGetQueryObjectui64v(slot.queries[2 * pass], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(slot.queries[2 * pass + 1], GL_QUERY_RESULT, &end);
+    times.pass_ms[pass] = static_cast<double>(end - begin) / 1e6;
+  }
+
+  history_.push_back(times.pass_ms);
+  if (history_.size() > history_size) {
+    history_.pop_front();
+  }
+  resolved_.push_back(std::move(times));
+  if (resolved_.size() > max_resolved) {
+    resolved_.pop_front();
+  }
+}
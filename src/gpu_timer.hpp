@@ -0,0 +1,97 @@
+#ifndef GLGRASSRENDERER_GPU_TIMER_HPP
+#define GLGRASSRENDERER_GPU_TIMER_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Measures the GPU time of render passes with GL_TIMESTAMP queries
+ *
+ * Each frame writes its timestamps into the queries of its FramePacer slot.
+ * A slot is read back when the ring comes around to it, by which time the
+ * pacer has waited for the GPU to finish the frame, so reading the results
+ * never stalls the pipeline. If a slot is still not available then, the
+ * frame is dropped rather than waited for.
+ */
+class GpuTimer {
+public:
+  /// Resolved frames averaged by average()
+  static constexpr std::size_t history_size = 120;
+
+  struct FrameTimes {
+    std::uint64_t frame = 0;
+    /// Milliseconds per pass, 0 for the passes the frame did not record
+    std::vector<double> pass_ms;
+  };
+
+  GpuTimer(std::vector<std::string> pass_names, std::size_t frames_in_flight);
+  ~GpuTimer();
+
+  GpuTimer(const GpuTimer&) = delete;
+  GpuTimer& operator=(const GpuTimer&) = delete;
+  GpuTimer(GpuTimer&&) = delete;
+  GpuTimer& operator=(GpuTimer&&) = delete;
+
+  /// Resolves the frame last recorded in `slot` and starts recording into it
+  void begin_frame(std::size_t slot);
+  /// Every pass may be recorded once per frame
+  void begin(std::size_t pass);
+  void end(std::size_t pass);
+
+  /// Waits for every recorded frame and resolves it
+  void flush();
+
+  /// The frame being recorded, counted from 0
+  [[nodiscard]] std::uint64_t frame() const noexcept
+  {
+    return frame_;
+  }
+
+  /// The frames resolved since the last call, oldest first. At most
+  /// `max_resolved` are kept when nobody takes them
+  [[nodiscard]] std::vector<FrameTimes> take_resolved();
+
+  /// Mean time of `pass` over the recent resolved frames, in milliseconds
+  [[nodiscard]] double average(std::size_t pass) const;
+
+  [[nodiscard]] const std::vector<std::string>& pass_names() const noexcept
+  {
+    return pass_names_;
+  }
+
+  [[nodiscard]] std::size_t dropped_frames() const noexcept
+  {
+    return dropped_frames_;
+  }
+
+private:
+  static constexpr std::size_t max_resolved = 1024;
+
+  struct Slot {
+    std::uint64_t frame = 0;
+    /// A begin and an end query per pass
+    std::vector<GLuint> queries;
+    std::vector<bool> recorded;
+    /// The last query issued, which completes after all the others
+    GLuint last_query = 0;
+    bool pending = false;
+  };
+
+  std::vector<std::string> pass_names_;
+  std::vector<Slot> ring_;
+  std::size_t current_ = 0;
+  std::uint64_t frame_ = 0;
+  bool recording_ = false;
+  std::size_t dropped_frames_ = 0;
+  std::deque<FrameTimes> resolved_;
+  std::deque<std::vector<double>> history_;
+
+  void resolve(Slot& slot, bool wait);
+};
+
+#endif // GLGRASSRENDERER_GPU_TIMER_HPP
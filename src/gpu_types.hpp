@@ -0,0 +1,163 @@
+#ifndef GLGRASSRENDERER_GPU_TYPES_HPP
+#define GLGRASSRENDERER_GPU_TYPES_HPP
+
+#include "buffer_layout.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+// C++ mirrors of the buffer blocks shared with the shaders. Their layouts are
+// checked against every program built with ShaderBuilder::expect_layout()
+
+/// std140 CameraBufferObject in include/camera.glsl
+struct CameraBufferObject {
+  glm::mat4 view;
+  glm::mat4 proj;
+  glm::vec3 position;
+  float padding = 0; // std140 rounds the block up to a multiple of a vec4
+};
+
+inline constexpr BufferMemberLayout camera_buffer_members[] = {
+    {"view", offsetof(CameraBufferObject, view)},
+    {"proj", offsetof(CameraBufferObject, proj)},
+    {"position", offsetof(CameraBufferObject, position)},
+};
+
+inline constexpr BufferBlockLayout camera_buffer_layout{
+    "CameraBufferObject", GL_UNIFORM_BLOCK, 0, sizeof(CameraBufferObject),
+    "CameraBufferObject.", 0, camera_buffer_members};
+
+/// std140 TerrainBufferObject in include/terrain.glsl
+struct TerrainBufferObject {
+  float tile_size = 1;
+  float height_scale = 1;
+  float tessellation_factor = 1;
+  std::uint32_t patches_per_side = 1;
+};
+
+inline constexpr BufferMemberLayout terrain_buffer_members[] = {
+    {"tile_size", offsetof(TerrainBufferObject, tile_size)},
+    {"height_scale", offsetof(TerrainBufferObject, height_scale)},
+    {"tessellation_factor",
+     offsetof(TerrainBufferObject, tessellation_factor)},
+    {"patches_per_side", offsetof(TerrainBufferObject, patches_per_side)},
+};
+
+inline constexpr BufferBlockLayout terrain_buffer_layout{
+    "TerrainBufferObject", GL_UNIFORM_BLOCK, 1, sizeof(TerrainBufferObject),
+    "TerrainBufferObject.", 0, terrain_buffer_members};
+
+/// std140 SimulationBufferObject in grass.comp.glsl
+struct SimulationBufferObject {
+  float current_time = 0; // Seconds
+  float delta_time = 0;   // Seconds
+  float wind_magnitude = 1;
+  float wind_wave_length = 1;
+  float wind_wave_period = 1;
+  float padding[3] = {}; // std140 rounds the block up to a multiple of a vec4
+};
+
+inline constexpr BufferMemberLayout simulation_buffer_members[] = {
+    {"current_time", offsetof(SimulationBufferObject, current_time)},
+    {"delta_time", offsetof(SimulationBufferObject, delta_time)},
+    {"wind_magnitude", offsetof(SimulationBufferObject, wind_magnitude)},
+    {"wind_wave_length", offsetof(SimulationBufferObject, wind_wave_length)},
+    {"wind_wave_period", offsetof(SimulationBufferObject, wind_wave_period)},
+};
+
+inline constexpr BufferBlockLayout simulation_buffer_layout{
+    "SimulationBufferObject", GL_UNIFORM_BLOCK, 2,
+    sizeof(SimulationBufferObject), "SimulationBufferObject.", 0,
+    simulation_buffer_members};
+
+/// std430 Tile in include/terrain.glsl
+struct TileEntry {
+  glm::ivec2 coord;
+  std::int32_t layer = 0; // Heightmap layer
+  std::uint32_t resident = 0;
+};
+
+inline constexpr BufferMemberLayout tile_entry_members[] = {
+    {"coord", offsetof(TileEntry, coord)},
+    {"layer", offsetof(TileEntry, layer)},
+    {"resident", offsetof(TileEntry, resident)},
+};
+
+inline constexpr BufferBlockLayout terrain_tiles_layout{
+    "TerrainTiles", GL_SHADER_STORAGE_BLOCK, 4, sizeof(TileEntry),
+    "terrain_tiles[0].", sizeof(TileEntry), tile_entry_members};
+
+inline constexpr BufferBlockLayout grass_tiles_layout{
+    "GrassTiles", GL_SHADER_STORAGE_BLOCK, 5, sizeof(TileEntry),
+    "grass_tiles[0].", sizeof(TileEntry), tile_entry_members};
+
+/// std140 Blade in include/blade.glsl
+struct Blade {
+  glm::vec4 v0; // xyz: Position, w: orientation (in radius)
+  glm::vec4 v1; // xyz: Bezier point w: height
+  glm::vec4 v2; // xyz: Physical model guide w: width
+  glm::vec4 up; // xyz: Up vector w: stiffness coefficient
+};
+
+inline constexpr BufferMemberLayout blade_members[] = {
+    {"v0", offsetof(Blade, v0)},
+    {"v1", offsetof(Blade, v1)},
+    {"v2", offsetof(Blade, v2)},
+    {"up", offsetof(Blade, up)},
+};
+
+inline constexpr BufferBlockLayout input_blades_layout{
+    "inputBuffer", GL_SHADER_STORAGE_BLOCK, 1, sizeof(Blade),
+    "inputBlades[0].", sizeof(Blade), blade_members};
+
+inline constexpr BufferBlockLayout output_blades_layout{
+    "outputBuffer", GL_SHADER_STORAGE_BLOCK, 2, sizeof(Blade),
+    "outputBlades[0].", sizeof(Blade), blade_members};
+
+/// std430 NumBlades in grass.comp.glsl, used as the indirect draw command
+struct NumBlades {
+  std::uint32_t vertexCount = 5;
+  std::uint32_t instanceCount = 1;
+  std::uint32_t firstVertex = 0;
+  std::uint32_t firstInstance = 0;
+};
+
+inline constexpr BufferMemberLayout num_blades_members[] = {
+    {"vertexCount", offsetof(NumBlades, vertexCount)},
+    {"instanceCount", offsetof(NumBlades, instanceCount)},
+    {"firstVertex", offsetof(NumBlades, firstVertex)},
+    {"firstInstance", offsetof(NumBlades, firstInstance)},
+};
+
+inline constexpr BufferBlockLayout num_blades_layout{
+    "NumBlades", GL_SHADER_STORAGE_BLOCK, 3, sizeof(NumBlades), "NumBlades.", 0,
+    num_blades_members};
+
+/// std430 GrassStatistics in grass.comp.glsl, cleared before every dispatch
+struct GrassStatistics {
+  /// Blades in resident tiles, which the other counters split
+  std::uint32_t resident_blades = 0;
+  std::uint32_t frustum_culled = 0;
+  std::uint32_t distance_culled = 0;
+  /// The drawn blades, by the tessellation levels they get
+  std::uint32_t near_lod_patches = 0;
+  std::uint32_t far_lod_patches = 0;
+  /// Drivers may round the block up to a multiple of 16 bytes
+  std::uint32_t padding[3] = {};
+};
+
+inline constexpr BufferMemberLayout grass_statistics_members[] = {
+    {"resident_blades", offsetof(GrassStatistics, resident_blades)},
+    {"frustum_culled", offsetof(GrassStatistics, frustum_culled)},
+    {"distance_culled", offsetof(GrassStatistics, distance_culled)},
+    {"near_lod_patches", offsetof(GrassStatistics, near_lod_patches)},
+    {"far_lod_patches", offsetof(GrassStatistics, far_lod_patches)},
+};
+
+inline constexpr BufferBlockLayout grass_statistics_layout{
+    "GrassStatistics", GL_SHADER_STORAGE_BLOCK, 6, sizeof(GrassStatistics),
+    "GrassStatistics.", 0, grass_statistics_members};
+
+#endif // GLGRASSRENDERER_GPU_TYPES_HPP
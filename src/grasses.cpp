@@ -1,4 +1,11 @@
 #include "grasses.hpp"
+#include "gl_extensions.hpp"
+#include "gl_state.hpp"
+#include "profiler.hpp"
+#include "terrain.hpp"
+
+#include <algorithm>
+#include <cstddef>
 
 #include <random>
 #include <vector>
@@ -7,38 +14,81 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/noise.hpp>
 
-#include <GLFW/glfw3.h>
+void Grasses::init(ResourceManager& resources, std::size_t frames_in_flight)
+{
+  PROFILE_ZONE("init_grass");
+  resources_ = &resources;
+  slots_.resize(max_tiles);
+
+  // Tiles are written into the input blades as they stream in, the output
+  // blades and the draw count only ever by the compute shader
+  const auto blades_size =
+      static_cast<GLsizeiptr>(max_tiles * blades_per_tile * sizeof(Blade));
+  input_blades_ = resources.buffer("Grass", {}, blades_size, nullptr,
+                                   GL_DYNAMIC_STORAGE_BIT);
+  gl_state().bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 1, input_blades_->id());
+
+  output_blades_ = resources.buffer("Grass", {}, blades_size, nullptr, 0);
+  gl_state().bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 2,
+                               output_blades_->id());
+
+  NumBlades numBlades;
+  num_blades_ =
+      resources.buffer("Grass", {}, sizeof(NumBlades), &numBlades, 0);
+  gl_state().bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 3, num_blades_->id());
+
+  tile_buffer_ = resources.buffer(
+      "Grass", {}, static_cast<GLsizeiptr>(slots_.size() * sizeof(TileEntry)),
+      slots_.data(), GL_DYNAMIC_STORAGE_BIT);
+  gl_state().bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 5, tile_buffer_->id());
 
-// Indirect drawing structure
-struct NumBlades {
-  std::uint32_t vertexCount = 5;
-  std::uint32_t instanceCount = 1;
-  std::uint32_t firstVertex = 0;
-  std::uint32_t firstInstance = 0;
-};
+  statistics_ = resources.buffer("Grass", {}, sizeof(GrassStatistics),
+                                 nullptr, GL_DYNAMIC_STORAGE_BIT);
+  gl_state().bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 6, statistics_->id());
+  statistics_readback_ = std::make_unique<ReadbackRing>(
+      frames_in_flight, sizeof(GrassStatistics) + sizeof(std::uint32_t));
+  readback_frames_.resize(frames_in_flight);
 
-struct Blade {
-  glm::vec4 v0; // xyz: Position, w: orientation (in radius)
-  glm::vec4 v1; // xyz: Bezier point w: height
-  glm::vec4 v2; // xyz: Physical model guide w: width
-  glm::vec4 up; // xyz: Up vector w: stiffness coefficient
-};
+  // The culled blades are drawn as patches of one vertex each
+  vertex_array_ = std::make_unique<VertexArray>();
+  vertex_array_->vertex_buffer(0, *output_blades_, 0, sizeof(Blade));
+  vertex_array_->attribute(0, 0, 4, GL_FLOAT, offsetof(Blade, v0));
+  vertex_array_->attribute(1, 0, 4, GL_FLOAT, offsetof(Blade, v1));
+  vertex_array_->attribute(2, 0, 4, GL_FLOAT, offsetof(Blade, v2));
+  vertex_array_->attribute(3, 0, 4, GL_FLOAT, offsetof(Blade, up));
 
-namespace {
+  // Submit the default permutations now so they compile alongside the
+  // others
+  (void)resources.program(compute_shader_builder());
+  (void)resources.program(grass_shader_builder());
+  (void)resources.program(depth_shader_builder());
+}
 
-std::vector<Blade> generate_blades()
+std::vector<Blade> Grasses::generate_tile(TileCoord coord)
 {
-  std::random_device rd;
-  std::mt19937 gen(rd());
+  PROFILE_ZONE("generate_blades");
+  // Seeded by the coordinates, so that a tile looks the same every time it
+  // is streamed in
+  std::seed_seq seed{coord.x, coord.z};
+  std::mt19937 gen(seed);
   std::uniform_real_distribution<float> orientation_dis(0, glm::pi<float>());
   std::uniform_real_distribution<float> dis(-1, 1);
 
+  constexpr float spacing = Terrain::tile_size / blades_per_side;
+  const glm::vec2 origin =
+      glm::vec2(static_cast<float>(coord.x), static_cast<float>(coord.z)) *
+      Terrain::tile_size;
+
   std::vector<Blade> blades;
-  // Generate grass blades using jittered stratified sampling
-  for (int i = -200; i < 200; ++i) {
-    for (int j = -200; j < 200; ++j) {
-      const float x = static_cast<float>(i) / 10 - 1 + dis(gen) * 0.1f;
-      const float y = static_cast<float>(j) / 10 - 1 + dis(gen) * 0.1f;
+  blades.reserve(blades_per_tile);
+  // Generate grass blades using jittered stratified sampling. The jitter
+  // keeps every blade inside its cell, and so inside its tile
+  for (int i = 0; i < blades_per_side; ++i) {
+    for (int j = 0; j < blades_per_side; ++j) {
+      const float x = origin.x + (static_cast<float>(i) + 0.5f) * spacing +
+                      dis(gen) * spacing * 0.5f;
+      const float y = origin.y + (static_cast<float>(j) + 0.5f) * spacing +
+                      dis(gen) * spacing * 0.5f;
 
       const float blade_height = glm::simplex(glm::vec2(x, y)) * 0.5f + 0.7f;
 
@@ -52,94 +102,203 @@ std::vector<Blade> generate_blades()
   return blades;
 }
 
-} // anonymous namespace
+bool Grasses::add_tile(TileCoord coord, int heightmap_layer,
+                       std::span<const Blade> blades)
+{
+  const auto slot = std::find_if(slots_.begin(), slots_.end(),
+                                 [](const auto& entry) {
+                                   return entry.resident == 0;
+                                 });
+  if (slot == slots_.end() || contains(coord) ||
+      blades.size() != blades_per_tile) {
+    return false;
+  }
+  *slot = {glm::ivec2(coord.x, coord.z), heightmap_layer, 1};
+  slots_changed_ = true;
+
+  const auto index = static_cast<std::size_t>(slot - slots_.begin());
+  input_blades_->update(static_cast<GLintptr>(index * blades.size_bytes()),
+                        static_cast<GLsizeiptr>(blades.size_bytes()),
+                        blades.data());
+  return true;
+}
+
+void Grasses::remove_tile(TileCoord coord)
+{
+  for (auto& slot : slots_) {
+    if (slot.resident != 0 && slot.coord == glm::ivec2(coord.x, coord.z)) {
+      slot.resident = 0;
+      slots_changed_ = true;
+    }
+  }
+}
 
-void Grasses::init()
+bool Grasses::contains(TileCoord coord) const
 {
-  const std::vector<Blade> blades = generate_blades();
-  blades_count_ = static_cast<GLuint>(blades.size());
+  return std::any_of(slots_.begin(), slots_.end(), [&](const auto& slot) {
+    return slot.resident != 0 && slot.coord == glm::ivec2(coord.x, coord.z);
+  });
+}
 
-  glPatchParameteri(GL_PATCH_VERTICES, 1);
+ShaderBuilder Grasses::compute_shader_builder() const
+{
+  return ShaderBuilder{}
+      .define("WORKGROUP_SIZE", workgroup_size)
+      .define("BLADES_PER_TILE", blades_per_tile)
+      .define("CULLING", culling ? 1 : 0)
+      // The only view the culling takes part in
+      .define("DEBUG_VIEW",
+              static_cast<int>(debug_view == DebugView::cull_reason
+                                   ? DebugView::cull_reason
+                                   : DebugView::none))
+      .load("grass.comp.glsl", Shader::Type::Compute)
+      .expect_layout(camera_buffer_layout)
+      .expect_layout(terrain_buffer_layout)
+      .expect_layout(simulation_buffer_layout)
+      .expect_layout(input_blades_layout)
+      .expect_layout(output_blades_layout)
+      .expect_layout(num_blades_layout)
+      .expect_layout(grass_tiles_layout)
+      .expect_layout(grass_statistics_layout);
+}
 
-  glGenVertexArrays(1, &grass_vao_);
-  glBindVertexArray(grass_vao_);
+ShaderBuilder Grasses::grass_shader_builder() const
+{
+  return ShaderBuilder{}
+      .define("DEBUG_VIEW", static_cast<int>(debug_view))
+      .load("grass.vert.glsl", Shader::Type::Vertex)
+      .load("grass.tesc.glsl", Shader::Type::TessControl)
+      .load("grass.tese.glsl", Shader::Type::TessEval)
+      .load("grass.frag.glsl", Shader::Type::Fragment)
+      .expect_layout(camera_buffer_layout);
+}
 
-  unsigned int grass_input_buffer = 0;
-  glGenBuffers(1, &grass_input_buffer);
+// The same stages up to the rasterizer, whose gl_Position is invariant, so
+// that the shading pass lands on the depth laid down exactly
+ShaderBuilder Grasses::depth_shader_builder()
+{
+  return ShaderBuilder{}
+      .load("grass.vert.glsl", Shader::Type::Vertex)
+      .load("grass.tesc.glsl", Shader::Type::TessControl)
+      .load("grass.tese.glsl", Shader::Type::TessEval)
+      .load("grass_depth.frag.glsl", Shader::Type::Fragment)
+      .expect_layout(camera_buffer_layout);
+}
 
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, grass_input_buffer);
-  glBufferData(GL_SHADER_STORAGE_BUFFER,
-               static_cast<GLsizei>(blades.size() * sizeof(Blade)),
-               blades.data(), GL_DYNAMIC_COPY);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, grass_input_buffer);
+void Grasses::update(const SimulationBufferObject& simulation,
+                     UploadRing& uploads)
+{
+  // Permutations selected after startup are compiled on first use
+  ShaderProgram& compute_shader =
+      resources_->program(compute_shader_builder());
+  compute_shader.finalize();
 
-  unsigned int grass_output_buffer = 0;
-  glGenBuffers(1, &grass_output_buffer);
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, grass_output_buffer);
-  glBufferData(GL_SHADER_STORAGE_BUFFER,
-               static_cast<GLsizei>(blades.size() * sizeof(Blade)), nullptr,
-               GL_STREAM_DRAW);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, grass_output_buffer);
+  compute_shader.use();
+  uploads.bind_uniforms(2, simulation);
 
-  NumBlades numBlades;
-  unsigned int grass_indirect_buffer = 0;
-  glGenBuffers(1, &grass_indirect_buffer);
-  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, grass_indirect_buffer);
-  glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(NumBlades), &numBlades,
-               GL_DYNAMIC_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, grass_output_buffer);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, grass_indirect_buffer);
-
-  // v0 attribute
-  glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Blade),
-                        reinterpret_cast<void*>(offsetof(Blade, v0)));
-  glEnableVertexAttribArray(0);
-
-  // v1 attribute
-  glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Blade),
-                        reinterpret_cast<void*>(offsetof(Blade, v1)));
-  glEnableVertexAttribArray(1);
-
-  // v2 attribute
-  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Blade),
-                        reinterpret_cast<void*>(offsetof(Blade, v2)));
-  glEnableVertexAttribArray(2);
-
-  // dir attribute
-  glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Blade),
-                        reinterpret_cast<void*>(offsetof(Blade, up)));
-  glEnableVertexAttribArray(3);
-
-  grass_compute_shader_ =
-      ShaderBuilder{}.load("grass.comp.glsl", Shader::Type::Compute).build();
-  grass_compute_shader_.use();
-
-  grass_shader_ = ShaderBuilder{}
-                      .load("grass.vert.glsl", Shader::Type::Vertex)
-                      .load("grass.tesc.glsl", Shader::Type::TessControl)
-                      .load("grass.tese.glsl", Shader::Type::TessEval)
-                      .load("grass.frag.glsl", Shader::Type::Fragment)
-                      .build();
-}
-
-void Grasses::update(DeltaDuration delta_time)
-{
-  grass_compute_shader_.use();
-  grass_compute_shader_.setFloat("current_time",
-                                 static_cast<float>(glfwGetTime()));
-  grass_compute_shader_.setFloat("delta_time", delta_time.count() / 1e3f);
-  grass_compute_shader_.setFloat("wind_magnitude", wind_magnitude);
-  grass_compute_shader_.setFloat("wind_wave_length", wind_wave_length);
-  grass_compute_shader_.setFloat("wind_wave_period", wind_wave_period);
-
-  glDispatchCompute(blades_count_, 1, 1);
+  gl_state().bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 5, tile_buffer_->id());
+  if (slots_changed_) {
+    tile_buffer_->update(
+        0, static_cast<GLsizeiptr>(slots_.size() * sizeof(TileEntry)),
+        slots_.data());
+    slots_changed_ = false;
+  }
+  const GrassStatistics cleared;
+  statistics_->update(0, sizeof(cleared), &cleared);
+  // Every workgroup appends to the draw command, so it is reset before the
+  // dispatch rather than by one of its invocations
+  glClearNamedBufferSubData(num_blades_->id(), GL_R32UI,
+                            offsetof(NumBlades, vertexCount),
+                            sizeof(NumBlades::vertexCount), GL_RED_INTEGER,
+                            GL_UNSIGNED_INT, nullptr);
+
+  constexpr GLuint blades_count = max_tiles * blades_per_tile;
+  glDispatchCompute((blades_count + workgroup_size - 1) / workgroup_size, 1,
+                    1);
 }
 
 void Grasses::render()
 {
-  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  ShaderProgram& grass_shader = resources_->program(grass_shader_builder());
+  grass_shader.finalize();
+
+  vertex_array_->bind();
+  grass_shader.use();
+  if (!depth_prepass) {
+    draw_blades();
+    return;
+  }
+  // Only the nearest fragment of each pixel matches the prepass depth, and
+  // is shaded once
+  glDepthFunc(GL_EQUAL);
+  glDepthMask(GL_FALSE);
+  draw_blades();
+  glDepthMask(GL_TRUE);
+  glDepthFunc(GL_LESS);
+}
+
+void Grasses::render_depth()
+{
+  ShaderProgram& depth_shader = resources_->program(depth_shader_builder());
+  depth_shader.finalize();
 
-  glBindVertexArray(grass_vao_);
-  grass_shader_.use();
+  vertex_array_->bind();
+  depth_shader.use();
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  draw_blades();
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+void Grasses::draw_blades()
+{
+  glPatchParameteri(GL_PATCH_VERTICES, 1);
+  gl_state().bind_buffer(GL_DRAW_INDIRECT_BUFFER, num_blades_->id());
   glDrawArraysIndirect(GL_PATCHES, reinterpret_cast<void*>(0));
 }
+
+void Grasses::read_back_statistics(std::size_t slot, std::uint64_t frame)
+{
+  resolve_statistics(slot);
+  statistics_readback_->copy(slot, 0, *statistics_, 0,
+                             sizeof(GrassStatistics));
+  statistics_readback_->copy(
+      slot, sizeof(GrassStatistics), *num_blades_,
+      offsetof(NumBlades, vertexCount), sizeof(std::uint32_t));
+  readback_frames_[slot] = frame;
+  readback_slot_ = slot;
+}
+
+void Grasses::flush_statistics()
+{
+  glFinish();
+  // Oldest first, so that the frames are resolved in order
+  for (std::size_t i = 1; i <= readback_frames_.size(); ++i) {
+    resolve_statistics((readback_slot_ + i) % readback_frames_.size());
+  }
+}
+
+std::vector<Grasses::Statistics> Grasses::take_statistics()
+{
+  std::vector<Statistics> resolved(statistics_resolved_.begin(),
+                                   statistics_resolved_.end());
+  statistics_resolved_.clear();
+  return resolved;
+}
+
+void Grasses::resolve_statistics(std::size_t slot)
+{
+  auto& frame = readback_frames_[slot];
+  if (!frame) {
+    return;
+  }
+  statistics_latest_ = {
+      *frame, statistics_readback_->read<GrassStatistics>(slot, 0),
+      statistics_readback_->read<std::uint32_t>(slot,
+                                                sizeof(GrassStatistics))};
+  frame.reset();
+
+  statistics_resolved_.push_back(statistics_latest_);
+  if (statistics_resolved_.size() > max_resolved_statistics) {
+    statistics_resolved_.pop_front();
+  }
+}
@@ -1,27 +1,147 @@
 #ifndef GLGRASSRENDERER_GRASSES_HPP
 #define GLGRASSRENDERER_GRASSES_HPP
 
+#include "gpu_types.hpp"
+#include "readback_ring.hpp"
+#include "resource_manager.hpp"
 #include "shader.hpp"
+#include "tile_coord.hpp"
+#include "upload_ring.hpp"
 
-#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
 
+/**
+ * @brief Grass blades streamed in tiles, simulated and culled by a compute
+ * shader
+ *
+ * The blade buffers are split into a fixed number of slots of
+ * blades_per_tile blades. A tile takes a free slot when it is added and
+ * releases it when it is evicted; the compute shader skips the blades of
+ * free slots. Each tile is planted on the terrain tile with the same
+ * coordinates, which must stay resident while the grass tile is.
+ */
 class Grasses {
-  unsigned int grass_vao_ = 0;
-  ShaderProgram grass_shader_{};
-  ShaderProgram grass_compute_shader_{};
-  GLuint blades_count_ = 0;
+  ResourceManager* resources_ = nullptr;
+  std::unique_ptr<VertexArray> vertex_array_;
+  std::shared_ptr<Buffer> input_blades_;
+  std::shared_ptr<Buffer> output_blades_;
+  std::shared_ptr<Buffer> num_blades_;
+  std::shared_ptr<Buffer> tile_buffer_;
+  std::shared_ptr<Buffer> statistics_;
+  std::vector<TileEntry> slots_;
+  bool slots_changed_ = false;
+
+  [[nodiscard]] ShaderBuilder compute_shader_builder() const;
+  [[nodiscard]] ShaderBuilder grass_shader_builder() const;
+  [[nodiscard]] static ShaderBuilder depth_shader_builder();
+  void draw_blades();
 
 public:
-  // Wind parameters
-  float wind_magnitude = 1.0;
-  float wind_wave_length = 1.0;
-  float wind_wave_period = 1.0;
+  /// Blades per side of a tile, 10 per meter
+  static constexpr int blades_per_side = 160;
+  static constexpr GLuint blades_per_tile = blades_per_side * blades_per_side;
+  /// Rings of tiles kept around the camera's tile
+  static constexpr int tile_radius = 1;
+  static constexpr int max_tiles =
+      (2 * tile_radius + 1) * (2 * tile_radius + 1);
+
+  // Compute shader specialization
+  static constexpr GLuint workgroup_sizes[] = {32, 64, 128, 256};
+  bool culling = true;
+  GLuint workgroup_size = 32;
+
+  /// How the blades are drawn, see data/include/debug_view.glsl
+  enum class DebugView {
+    none,
+    /// Counts the fragments shaded per pixel into an OverdrawHeatmap bound
+    /// by the caller
+    overdraw,
+    /// Colours the blades by their tessellation level
+    lod,
+    /// Draws the culled blades too, coloured by why they were culled
+    cull_reason,
+  };
+  static constexpr const char* debug_view_names[] = {"None", "Overdraw",
+                                                     "LOD", "Cull Reason"};
+  DebugView debug_view = DebugView::none;
+
+  /// Whether render_depth() runs before render(), which then shades only the
+  /// fragments at the depth it laid down
+  bool depth_prepass = false;
+
+  /// What became of the blades in one frame
+  struct Statistics {
+    std::uint64_t frame = 0;
+    GrassStatistics counts;
+    /// The vertex count of the indirect draw
+    std::uint32_t drawn_blades = 0;
+  };
+
+  Grasses() = default;
+  ~Grasses() = default;
+
+  Grasses(const Grasses&) = delete;
+  Grasses& operator=(const Grasses&) = delete;
+  Grasses(Grasses&&) = delete;
+  Grasses& operator=(Grasses&&) = delete;
+
+  /// `resources` must outlive the grasses. Statistics are read back
+  /// `frames_in_flight` frames late
+  void init(ResourceManager& resources, std::size_t frames_in_flight);
 
-  using DeltaDuration = std::chrono::duration<float, std::milli>;
+  /// Generates the blades of `coord`, planted at y = 0. Safe to call from
+  /// any thread
+  [[nodiscard]] static std::vector<Blade> generate_tile(TileCoord coord);
 
-  void init();
-  void update(DeltaDuration delta_time);
+  /// Uploads the blades of `coord` into a free slot, planted on the
+  /// heightmap layer `heightmap_layer`. Returns false when every slot is
+  /// taken
+  bool add_tile(TileCoord coord, int heightmap_layer,
+                std::span<const Blade> blades);
+  void remove_tile(TileCoord coord);
+  [[nodiscard]] bool contains(TileCoord coord) const;
+
+  /// Advances the blades by `simulation.delta_time` in the wind of
+  /// `simulation`, whose constants are written to `uploads`
+  void update(const SimulationBufferObject& simulation, UploadRing& uploads);
+  /// Draws the blades culled by update(). The caller orders the culling
+  /// writes before it with a command and vertex attribute barrier
   void render();
+  /// Draws only the depth of the blades, for depth_prepass
+  void render_depth();
+
+  /// Copies the statistics of this frame's update() into the readback
+  /// `slot` of the frame pacer, and resolves the ones copied when the slot
+  /// was last used. Needs a buffer update barrier after update()
+  void read_back_statistics(std::size_t slot, std::uint64_t frame);
+  /// Waits for the GPU and resolves every statistics still in flight
+  void flush_statistics();
+
+  /// The statistics resolved since the last call, oldest first
+  [[nodiscard]] std::vector<Statistics> take_statistics();
+
+  /// The last statistics resolved
+  [[nodiscard]] const Statistics& statistics() const noexcept
+  {
+    return statistics_latest_;
+  }
+
+private:
+  static constexpr std::size_t max_resolved_statistics = 1024;
+
+  std::unique_ptr<ReadbackRing> statistics_readback_;
+  /// The frame whose statistics each readback slot holds, if any
+  std::vector<std::optional<std::uint64_t>> readback_frames_;
+  std::size_t readback_slot_ = 0;
+  Statistics statistics_latest_;
+  std::deque<Statistics> statistics_resolved_;
+
+  void resolve_statistics(std::size_t slot);
 };
 
 #endif // GLGRASSRENDERER_GRASSES_HPP
@@ -0,0 +1,150 @@
+#include "headless_context.hpp"
+
+#include <fmt/format.h>
+
+#include <stdexcept>
+
+// Without GLGRASS_HEADLESS the app is not linked against EGL, and creating a
+// headless context fails
+#ifdef GLGRASS_HEADLESS
+
+// Keep Xlib out of eglplatform.h
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace {
+
+[[nodiscard]] EGLDisplay open_display()
+{
+  // The surfaceless platform works without a display server or a GPU
+  const auto get_platform_display =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+          eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (get_platform_display != nullptr) {
+    EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                              EGL_DEFAULT_DISPLAY, nullptr);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+      return display;
+    }
+  }
+
+  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+    throw std::runtime_error{
+        fmt::format("Failed to initialize EGL: error {:#x}", eglGetError())};
+  }
+  return display;
+}
+
+} // anonymous namespace
+
+HeadlessContext::HeadlessContext()
+{
+  EGLDisplay display = open_display();
+  display_ = display;
+
+  if (!eglBindAPI(EGL_OPENGL_API)) {
+    eglTerminate(display);
+    throw std::runtime_error{"EGL does not support desktop OpenGL"};
+  }
+
+  constexpr EGLint config_attributes[] = {
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+  EGLConfig config = nullptr;
+  EGLint config_count = 0;
+  eglChooseConfig(display, config_attributes, &config, 1, &config_count);
+
+  constexpr EGLint context_attributes[] = {
+      EGL_CONTEXT_MAJOR_VERSION,
+      4,
+      EGL_CONTEXT_MINOR_VERSION,
+      5,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE};
+  // Without a matching config, rely on EGL_KHR_no_config_context
+  EGLContext context =
+      eglCreateContext(display, config_count > 0 ? config : nullptr,
+                       EGL_NO_CONTEXT, context_attributes);
+  if (context == EGL_NO_CONTEXT) {
+    const EGLint error = eglGetError();
+    eglTerminate(display);
+    throw std::runtime_error{fmt::format(
+        "Failed to create an OpenGL 4.5 core context: error {:#x}", error)};
+  }
+  context_ = context;
+
+  // Needs EGL_KHR_surfaceless_context
+  if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    const EGLint error = eglGetError();
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+    throw std::runtime_error{fmt::format(
+        "Failed to make the headless context current: error {:#x}", error)};
+  }
+}
+
+HeadlessContext::~HeadlessContext()
+{
+  eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  eglDestroyContext(display_, context_);
+  eglTerminate(display_);
+}
+
+GLADloadproc HeadlessContext::proc_loader() noexcept
+{
+  return reinterpret_cast<GLADloadproc>(eglGetProcAddress);
+}
+
+#else
+
+HeadlessContext::HeadlessContext()
+{
+  throw std::runtime_error{"Built without headless support (GLGRASS_HEADLESS)"};
+}
+
+HeadlessContext::~HeadlessContext() = default;
+
+GLADloadproc HeadlessContext::proc_loader() noexcept
+{
+  return nullptr;
+}
+
+#endif
+
+OffscreenFramebuffer::OffscreenFramebuffer(int width, int height)
+    : width_{width}, height_{height}
+{
+  glGenRenderbuffers(2, renderbuffers_);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers_[0]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers_[1]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+  glGenFramebuffers(1, &framebuffer_);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, renderbuffers_[0]);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                            GL_RENDERBUFFER, renderbuffers_[1]);
+  if (const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+      status != GL_FRAMEBUFFER_COMPLETE) {
+    glDeleteFramebuffers(1, &framebuffer_);
+    glDeleteRenderbuffers(2, renderbuffers_);
+    throw std::runtime_error{
+        fmt::format("Offscreen framebuffer is incomplete: {:#x}", status)};
+  }
+}
+
+OffscreenFramebuffer::~OffscreenFramebuffer()
+{
+  glDeleteFramebuffers(1, &framebuffer_);
+  glDeleteRenderbuffers(2, renderbuffers_);
+}
+
+void OffscreenFramebuffer::bind() const
+{
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  glViewport(0, 0, width_, height_);
+}
@@ -0,0 +1,56 @@
+#ifndef GLGRASSRENDERER_HEADLESS_CONTEXT_HPP
+#define GLGRASSRENDERER_HEADLESS_CONTEXT_HPP
+
+#include <glad/glad.h>
+
+/**
+ * @brief An OpenGL 4.5 core context that needs neither a window nor a
+ * display
+ *
+ * Created through EGL on Mesa's surfaceless platform, which falls back to the
+ * llvmpipe software rasterizer on machines without a GPU. The context has no
+ * default framebuffer: render into a framebuffer object. Throws
+ * std::runtime_error when no such context can be created.
+ */
+class HeadlessContext {
+public:
+  HeadlessContext();
+  ~HeadlessContext();
+
+  HeadlessContext(const HeadlessContext&) = delete;
+  HeadlessContext& operator=(const HeadlessContext&) = delete;
+  HeadlessContext(HeadlessContext&&) = delete;
+  HeadlessContext& operator=(HeadlessContext&&) = delete;
+
+  /// Loader for gladLoadGLLoader() and load_gl_extensions()
+  [[nodiscard]] static GLADloadproc proc_loader() noexcept;
+
+private:
+  // EGLDisplay and EGLContext, kept opaque so that the EGL headers stay out
+  // of the rest of the renderer
+  void* display_ = nullptr;
+  void* context_ = nullptr;
+};
+
+/// A color and depth render target of a fixed size for offscreen rendering
+class OffscreenFramebuffer {
+public:
+  OffscreenFramebuffer(int width, int height);
+  ~OffscreenFramebuffer();
+
+  OffscreenFramebuffer(const OffscreenFramebuffer&) = delete;
+  OffscreenFramebuffer& operator=(const OffscreenFramebuffer&) = delete;
+  OffscreenFramebuffer(OffscreenFramebuffer&&) = delete;
+  OffscreenFramebuffer& operator=(OffscreenFramebuffer&&) = delete;
+
+  /// Binds the framebuffer for drawing and sets the viewport to cover it
+  void bind() const;
+
+private:
+  GLuint framebuffer_ = 0;
+  GLuint renderbuffers_[2] = {};
+  int width_ = 0;
+  int height_ = 0;
+};
+
+#endif // GLGRASSRENDERER_HEADLESS_CONTEXT_HPP
@@ -0,0 +1,182 @@
+#include "ktx2.hpp"
+#include "bc1.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// File layout, all integers little-endian:
+//
+//   identifier               12 bytes
+//   header                   9 x uint32
+//   index                    dfd and kvd offset and length (uint32),
+//                            sgd offset and length (uint64)
+//   level index              level_count x 3 x uint64
+//   data format descriptor
+//   mip levels               smallest first, each aligned to 8 bytes
+
+constexpr unsigned char identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                          0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+constexpr std::size_t header_size = sizeof(identifier) + 9 * 4 + 4 * 4 + 2 * 8;
+constexpr std::size_t level_index_entry_size = 3 * 8;
+constexpr std::size_t level_alignment = 8;
+
+[[nodiscard]] std::uint64_t read_le(std::span<const unsigned char> bytes,
+                                    std::size_t offset, std::size_t size)
+{
+  if (offset > bytes.size() || size > bytes.size() - offset) {
+    throw std::runtime_error{"KTX2 file is truncated"};
+  }
+  std::uint64_t value = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    value |= std::uint64_t{bytes[offset + i]} << (8 * i);
+  }
+  return value;
+}
+
+void write_le(std::vector<unsigned char>& out, std::uint64_t value,
+              std::size_t size)
+{
+  for (std::size_t i = 0; i < size; ++i) {
+    out.push_back(static_cast<unsigned char>((value >> (8 * i)) & 0xFFu));
+  }
+}
+
+/// The basic data format descriptor of a BC1 RGB texture
+[[nodiscard]] std::vector<unsigned char> bc1_descriptor()
+{
+  constexpr std::uint32_t block_size = 24 + 16;
+  std::vector<unsigned char> dfd;
+  write_le(dfd, 4 + block_size, 4); // dfdTotalSize
+  write_le(dfd, 0, 4);              // Khronos vendor, basic descriptor type
+  write_le(dfd, 2 | block_size << 16, 4);
+  // BC1A color model, BT.709 primaries, linear transfer function
+  write_le(dfd, 128 | 1 << 8 | 1 << 16, 4);
+  write_le(dfd, 3 | 3 << 8, 4); // 4x4 texel blocks
+  write_le(dfd, bc1_block_size, 4);
+  write_le(dfd, 0, 4);
+  // A single sample spanning all 64 bits of the block
+  write_le(dfd, 63 << 16, 4);
+  write_le(dfd, 0, 4);
+  write_le(dfd, 0, 4);
+  write_le(dfd, 0xFFFFFFFF, 4);
+  return dfd;
+}
+
+[[nodiscard]] std::size_t level_size(const Ktx2Texture& texture,
+                                     std::size_t level)
+{
+  const auto width = std::max<std::size_t>(texture.width >> level, 1);
+  const auto height = std::max<std::size_t>(texture.height >> level, 1);
+  return bc1_image_size(width, height) * texture.face_count;
+}
+
+} // anonymous namespace
+
+Ktx2Texture read_ktx2(std::span<const unsigned char> file)
+{
+  if (file.size() < header_size ||
+      std::memcmp(file.data(), identifier, sizeof(identifier)) != 0) {
+    throw std::runtime_error{"Not a KTX2 file"};
+  }
+
+  const auto header = [&](std::size_t index) {
+    return static_cast<std::uint32_t>(
+        read_le(file, sizeof(identifier) + 4 * index, 4));
+  };
+  Ktx2Texture texture;
+  texture.vk_format = header(0);
+  texture.width = header(2);
+  texture.height = header(3);
+  const auto depth = header(4);
+  const auto layer_count = header(5);
+  texture.face_count = header(6);
+  const auto level_count = std::max(header(7), 1u);
+  const auto supercompression = header(8);
+
+  if (texture.vk_format != vk_format_bc1_rgb_unorm_block) {
+    throw std::runtime_error{
+        fmt::format("Unsupported KTX2 format {}", texture.vk_format)};
+  }
+  if (texture.width == 0 || texture.height == 0 || depth > 1 ||
+      layer_count > 1 || (texture.face_count != 1 && texture.face_count != 6) ||
+      supercompression != 0) {
+    throw std::runtime_error{"Only 2D textures and cube maps are supported"};
+  }
+  if (level_count > std::bit_width(std::max(texture.width, texture.height))) {
+    throw std::runtime_error{"KTX2 file has too many levels"};
+  }
+
+  for (std::size_t level = 0; level < level_count; ++level) {
+    const auto entry = header_size + level * level_index_entry_size;
+    const auto offset = read_le(file, entry, 8);
+    const auto length = read_le(file, entry + 8, 8);
+    if (length != level_size(texture, level) || offset > file.size() ||
+        length > file.size() - offset) {
+      throw std::runtime_error{
+          fmt::format("KTX2 level {} is out of bounds", level)};
+    }
+    texture.levels.push_back(file.subspan(offset, length));
+  }
+  return texture;
+}
+
+std::vector<unsigned char> write_ktx2(const Ktx2Texture& texture)
+{
+  if (texture.vk_format != vk_format_bc1_rgb_unorm_block) {
+    throw std::runtime_error{
+        fmt::format("Unsupported KTX2 format {}", texture.vk_format)};
+  }
+
+  const auto level_count = texture.levels.size();
+  const auto dfd = bc1_descriptor();
+  const auto dfd_offset = header_size + level_count * level_index_entry_size;
+
+  std::vector<unsigned char> out(identifier, identifier + sizeof(identifier));
+  write_le(out, texture.vk_format, 4);
+  write_le(out, 1, 4); // typeSize
+  write_le(out, texture.width, 4);
+  write_le(out, texture.height, 4);
+  write_le(out, 0, 4); // pixelDepth
+  write_le(out, 0, 4); // layerCount
+  write_le(out, texture.face_count, 4);
+  write_le(out, level_count, 4);
+  write_le(out, 0, 4); // No supercompression
+  write_le(out, dfd_offset, 4);
+  write_le(out, dfd.size(), 4);
+  write_le(out, 0, 4); // No key/value data
+  write_le(out, 0, 4);
+  write_le(out, 0, 8); // No supercompression global data
+  write_le(out, 0, 8);
+
+  // The smallest level comes first in the file
+  std::vector<std::uint64_t> offsets(level_count);
+  auto offset = dfd_offset + dfd.size();
+  for (std::size_t level = level_count; level-- > 0;) {
+    offset = (offset + level_alignment - 1) / level_alignment * level_alignment;
+    offsets[level] = offset;
+    offset += texture.levels[level].size();
+  }
+  for (std::size_t level = 0; level < level_count; ++level) {
+    if (texture.levels[level].size() != level_size(texture, level)) {
+      throw std::runtime_error{
+          fmt::format("Level {} has the wrong size", level)};
+    }
+    write_le(out, offsets[level], 8);
+    write_le(out, texture.levels[level].size(), 8);
+    write_le(out, texture.levels[level].size(), 8);
+  }
+
+  out.insert(out.end(), dfd.begin(), dfd.end());
+  for (std::size_t level = level_count; level-- > 0;) {
+    out.resize(offsets[level]);
+    out.insert(out.end(), texture.levels[level].begin(),
+               texture.levels[level].end());
+  }
+  return out;
+}
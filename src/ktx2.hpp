@@ -0,0 +1,38 @@
+#ifndef GLGRASSRENDERER_KTX2_HPP
+#define GLGRASSRENDERER_KTX2_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Reading and writing of the subset of KTX 2.0 used for our textures: 2D
+// textures and cube maps, without supercompression.
+
+/// The VkFormat values we store
+inline constexpr std::uint32_t vk_format_bc1_rgb_unorm_block = 131;
+
+struct Ktx2Texture {
+  std::uint32_t vk_format = 0;
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  std::uint32_t face_count = 1;
+  /// Level 0 is the base level. Each level holds all faces back to back
+  std::vector<std::span<const unsigned char>> levels;
+
+  /// The bytes of one face within a level
+  [[nodiscard]] std::span<const unsigned char>
+  face(std::size_t level, std::size_t face_index) const
+  {
+    const auto face_size = levels[level].size() / face_count;
+    return levels[level].subspan(face_index * face_size, face_size);
+  }
+};
+
+/// Parses a KTX2 file, the levels are views into `file`. Throws
+/// std::runtime_error if it is malformed or uses features we do not support
+[[nodiscard]] Ktx2Texture read_ktx2(std::span<const unsigned char> file);
+
+/// Serializes a block-compressed texture
+[[nodiscard]] std::vector<unsigned char> write_ktx2(const Ktx2Texture& texture);
+
+#endif // GLGRASSRENDERER_KTX2_HPP
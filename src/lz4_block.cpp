@@ -0,0 +1,180 @@
+#include "lz4_block.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t min_match = 4;
+// The format requires the last 5 bytes to be literals, and the last match to
+// start at least 12 bytes before the end
+constexpr std::size_t last_literals = 5;
+constexpr std::size_t match_find_limit = 12;
+constexpr std::size_t max_offset = 65535;
+constexpr unsigned hash_bits = 16;
+
+[[nodiscard]] std::uint32_t read32(const unsigned char* p)
+{
+  std::uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+[[nodiscard]] std::size_t hash(std::uint32_t sequence)
+{
+  return (sequence * 2654435761u) >> (32 - hash_bits);
+}
+
+void write_length(std::vector<unsigned char>& out, std::size_t length)
+{
+  for (; length >= 255; length -= 255) {
+    out.push_back(255);
+  }
+  out.push_back(static_cast<unsigned char>(length));
+}
+
+void write_sequence(std::vector<unsigned char>& out,
+                    std::span<const unsigned char> literals,
+                    std::size_t offset, std::size_t match_length)
+{
+  const std::size_t match_code = match_length - min_match;
+  out.push_back(static_cast<unsigned char>(
+      (std::min<std::size_t>(literals.size(), 15) << 4) |
+      std::min<std::size_t>(match_code, 15)));
+  if (literals.size() >= 15) {
+    write_length(out, literals.size() - 15);
+  }
+  out.insert(out.end(), literals.begin(), literals.end());
+
+  out.push_back(static_cast<unsigned char>(offset & 0xFF));
+  out.push_back(static_cast<unsigned char>(offset >> 8));
+  if (match_code >= 15) {
+    write_length(out, match_code - 15);
+  }
+}
+
+void write_last_literals(std::vector<unsigned char>& out,
+                         std::span<const unsigned char> literals)
+{
+  out.push_back(static_cast<unsigned char>(
+      std::min<std::size_t>(literals.size(), 15) << 4));
+  if (literals.size() >= 15) {
+    write_length(out, literals.size() - 15);
+  }
+  out.insert(out.end(), literals.begin(), literals.end());
+}
+
+// Reads the 255-terminated extension of a length field
+[[nodiscard]] bool read_length(std::span<const unsigned char> src,
+                               std::size_t& pos, std::size_t& length)
+{
+  unsigned char byte = 255;
+  while (byte == 255) {
+    if (pos >= src.size()) {
+      return false;
+    }
+    byte = src[pos++];
+    length += byte;
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+std::vector<unsigned char> lz4_compress(std::span<const unsigned char> src)
+{
+  std::vector<unsigned char> out;
+  out.reserve(src.size() / 2 + 16);
+
+  std::size_t anchor = 0;
+  if (src.size() > match_find_limit) {
+    constexpr auto empty = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> table(std::size_t{1} << hash_bits, empty);
+
+    const std::size_t match_start_limit = src.size() - match_find_limit;
+    const std::size_t match_end_limit = src.size() - last_literals;
+
+    std::size_t pos = 0;
+    while (pos < match_start_limit) {
+      const auto sequence = read32(src.data() + pos);
+      auto& slot = table[hash(sequence)];
+      const std::size_t candidate = slot;
+      slot = pos;
+
+      if (candidate == empty || pos - candidate > max_offset ||
+          read32(src.data() + candidate) != sequence) {
+        ++pos;
+        continue;
+      }
+
+      std::size_t length = min_match;
+      while (pos + length < match_end_limit &&
+             src[candidate + length] == src[pos + length]) {
+        ++length;
+      }
+
+      write_sequence(out, src.subspan(anchor, pos - anchor), pos - candidate,
+                     length);
+      pos += length;
+      anchor = pos;
+    }
+  }
+
+  write_last_literals(out, src.subspan(anchor));
+  return out;
+}
+
+bool lz4_decompress(std::span<const unsigned char> src,
+                    std::span<unsigned char> dst)
+{
+  std::size_t in = 0;
+  std::size_t out = 0;
+
+  while (in < src.size()) {
+    const unsigned char token = src[in++];
+
+    std::size_t literal_length = token >> 4;
+    if (literal_length == 15 && !read_length(src, in, literal_length)) {
+      return false;
+    }
+    if (literal_length > src.size() - in || literal_length > dst.size() - out) {
+      return false;
+    }
+    std::copy_n(src.begin() + static_cast<std::ptrdiff_t>(in), literal_length,
+                dst.begin() + static_cast<std::ptrdiff_t>(out));
+    in += literal_length;
+    out += literal_length;
+
+    // The block always ends with literals
+    if (in == src.size()) {
+      break;
+    }
+
+    if (src.size() - in < 2) {
+      return false;
+    }
+    const std::size_t offset =
+        src[in] | static_cast<std::size_t>(src[in + 1]) << 8;
+    in += 2;
+    if (offset == 0 || offset > out) {
+      return false;
+    }
+
+    std::size_t match_length = token & 0x0F;
+    if (match_length == 15 && !read_length(src, in, match_length)) {
+      return false;
+    }
+    match_length += min_match;
+    if (match_length > dst.size() - out) {
+      return false;
+    }
+
+    // Matches may overlap their own output, so copy byte by byte
+    for (std::size_t i = 0; i < match_length; ++i, ++out) {
+      dst[out] = dst[out - offset];
+    }
+  }
+
+  return out == dst.size();
+}
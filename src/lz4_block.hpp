@@ -0,0 +1,19 @@
+#ifndef GLGRASSRENDERER_LZ4_BLOCK_HPP
+#define GLGRASSRENDERER_LZ4_BLOCK_HPP
+
+#include <span>
+#include <vector>
+
+// A minimal codec for the LZ4 block format. It favors decompression speed
+// over ratio, which is the right trade-off for assets read at startup.
+
+/// Compresses `src` into a single LZ4 block
+[[nodiscard]] std::vector<unsigned char>
+lz4_compress(std::span<const unsigned char> src);
+
+/// Decompresses an LZ4 block into `dst`. Returns false if `src` is malformed
+/// or does not decompress to exactly `dst.size()` bytes
+[[nodiscard]] bool lz4_decompress(std::span<const unsigned char> src,
+                                  std::span<unsigned char> dst);
+
+#endif // GLGRASSRENDERER_LZ4_BLOCK_HPP
@@ -1,21 +1,49 @@
 #include <glad/glad.h>
 
 #include <GLFW/glfw3.h>
-#include <stb_image.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <chrono>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <memory>
+#include <optional>
 
+#include "asset_pack.hpp"
+#include "benchmark.hpp"
 #include "camera.hpp"
+#include "frame_pacer.hpp"
+#include "frame_stats.hpp"
+#include "gl_extensions.hpp"
+#include "gl_state.hpp"
+#include "gpu_timer.hpp"
+#include "gpu_types.hpp"
 #include "grasses.hpp"
-#include "model.hpp"
+#include "headless_context.hpp"
+#include "overdraw_heatmap.hpp"
+#include "pipeline_statistics.hpp"
+#include "profiler.hpp"
+#include "render_graph.hpp"
+#include "resource_manager.hpp"
 #include "shader.hpp"
+#include "shader_watcher.hpp"
+#include "simulation.hpp"
+#include "terrain.hpp"
+#include "texture.hpp"
+#include "tile_streamer.hpp"
+#include "upload_ring.hpp"
 
 #include <fmt/format.h>
 
@@ -77,83 +105,23 @@ constexpr float skybox_vertices[] = {
 };
 // clang-format on
 
-void load_gl()
+void load_gl(GLADloadproc loader)
 {
   // glad: load all OpenGL function pointers
   // ---------------------------------------
-  if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
-    fmt::print(stderr, "Failed to initialize GLAD\n");
-    glfwTerminate();
-    std::exit(1);
+  if (!gladLoadGLLoader(loader)) {
+    throw std::runtime_error{"Failed to initialize GLAD"};
   }
-}
-
-[[nodiscard]] std::unique_ptr<Mesh> generate_terrain_model()
-{
-  constexpr std::size_t terrian_x_max = 20;
-  constexpr std::size_t terrian_y_max = 20;
-
-  std::vector<Vertex> verts;
-  std::vector<std::uint32_t> indices;
-  verts.reserve(terrian_x_max * terrian_y_max * 4);
-  indices.reserve(terrian_x_max * terrian_y_max * 6);
-
-  for (std::size_t x = 0; x < terrian_x_max; ++x) {
-    const float x_offset =
-        -static_cast<float>(terrian_x_max) + 2 * static_cast<float>(x);
-    for (std::size_t y = 0; y < terrian_y_max; ++y) {
-      const float y_offset =
-          -static_cast<float>(terrian_y_max) + 2 * static_cast<float>(y);
-      verts.push_back({{1.0f + x_offset, 0.0f, 1.0f + y_offset}, {1.0f, 0.0f}});
-      verts.push_back(
-          {{1.0f + x_offset, 0.0f, -1.0f + y_offset}, {1.0f, 1.0f}});
-      verts.push_back(
-          {{-1.0f + x_offset, 0.0f, -1.0f + y_offset}, {0.0f, 1.0f}});
-      verts.push_back(
-          {{-1.0f + x_offset, 0.0f, 1.0f + y_offset}, {0.0f, 0.0f}});
-
-      const auto index_base =
-          static_cast<std::uint32_t>(4 * (y + x * terrian_y_max));
-      indices.push_back(index_base);
-      indices.push_back(index_base + 1);
-      indices.push_back(index_base + 3);
-      indices.push_back(index_base + 1);
-      indices.push_back(index_base + 2);
-      indices.push_back(index_base + 3);
-    }
-  }
-
-  return std::make_unique<Mesh>(std::move(verts), std::move(indices),
-                                "GrassGreenTexture0001.jpg");
-}
 
-unsigned int load_cubemap(std::vector<std::string> faces)
-{
-  unsigned int texture_id;
-  glGenTextures(1, &texture_id);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id);
-
-  int width, height, nrChannels;
-  for (unsigned int i = 0; i < faces.size(); i++) {
-    unsigned char* data =
-        stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-    if (data) {
-      glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height,
-                   0, GL_RGB, GL_UNSIGNED_BYTE, data);
-      stbi_image_free(data);
-    } else {
-      std::cout << "Cubemap texture failed to load at path: " << faces[i]
-                << std::endl;
-      stbi_image_free(data);
-    }
+  load_gl_extensions(loader);
+  if (!gl_extensions().direct_state_access) {
+    throw std::runtime_error{"OpenGL 4.5 direct state access is required "
+                             "(GL_ARB_direct_state_access)"};
+  }
+  if (gl_extensions().parallel_shader_compile) {
+    // Let the driver pick as many compiler threads as it sees fit
+    glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
   }
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-  return texture_id;
 }
 
 void init_imgui(GLFWwindow* window)
@@ -169,39 +137,254 @@ void init_imgui(GLFWwindow* window)
   ImGui::StyleColorsDark();
   // ImGui::StyleColorsClassic();
 
-  // Setup Platform/Renderer bindings
-  ImGui_ImplGlfw_InitForOpenGL(window, true);
+  // Setup Platform/Renderer bindings. Without a window, App::draw_gui()
+  // feeds the display size and the time step itself
+  if (window != nullptr) {
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+  }
   ImGui_ImplOpenGL3_Init("#version 450");
 
   // Load Fonts
-  io.Fonts->AddFontFromFileTTF("./fonts/Roboto-Medium.ttf", 30.0f);
+  if (auto font = load_asset("fonts/Roboto-Medium.ttf")) {
+    ImFontConfig config;
+    void* font_data = const_cast<unsigned char*>(font->data());
+    if (font->is_view()) {
+      // Points into the mapped asset pack, which outlives ImGui
+      config.FontDataOwnedByAtlas = false;
+    } else {
+      font_data = IM_ALLOC(font->size());
+      std::memcpy(font_data, font->data(), font->size());
+    }
+    io.Fonts->AddFontFromMemoryTTF(font_data, static_cast<int>(font->size()),
+                                   30.0f, &config);
+  }
 }
 
-void destroy_imgui()
+void destroy_imgui(bool with_window)
 {
   ImGui_ImplOpenGL3_Shutdown();
-  ImGui_ImplGlfw_Shutdown();
+  if (with_window) {
+    ImGui_ImplGlfw_Shutdown();
+  }
   ImGui::DestroyContext();
 }
 
+/// Destroys the window, and its GL context with it, then terminates GLFW
+struct WindowDeleter {
+  void operator()(GLFWwindow* window) const noexcept
+  {
+    glfwDestroyWindow(window);
+    glfwTerminate();
+  }
+};
+
+struct Options {
+  /// Render offscreen without a window, then exit
+  bool headless = false;
+  int width = 1920;
+  int height = 1080;
+  /// Frames measured in headless and benchmark mode
+  int frames = 600;
+
+  /// Fly along `camera_path` with a fixed time step and write reports
+  bool benchmark = false;
+  std::string camera_path = "camera_paths/flyover.txt";
+  /// Frames rendered before the measured ones
+  int warmup_frames = 60;
+  double timestep_ms = 1000.0 / 60;
+  /// The reports are written to <report>.json and <report>.csv
+  std::string report = "benchmark";
+
+  /// Chrome trace of the profiler zones written on exit, none when empty
+  std::string trace;
+
+  /// Frames the CPU may submit before waiting for the GPU
+  std::size_t frames_in_flight = 2;
+  /// Count the shader invocations of the culling and the grass draw
+  bool pipeline_statistics = false;
+  /// Lay down the depth of the grass before shading it
+  bool depth_prepass = false;
+};
+
+void print_usage()
+{
+  fmt::print(
+      "Usage: app [--headless] [--benchmark] [options]\n"
+      "  --headless          render offscreen without a window, print the\n"
+      "                      frame times and exit\n"
+      "  --benchmark         fly along a camera path with a fixed time step,\n"
+      "                      write JSON and CSV reports and exit\n"
+      "  --frames N          frames to measure (600)\n"
+      "  --size WxH          framebuffer size (1920x1080)\n"
+      "  --frames-in-flight N\n"
+      "                      frames the CPU submits ahead of the GPU, 1 to 4\n"
+      "                      (2)\n"
+      "  --camera-path FILE  benchmark camera path\n"
+      "                      (camera_paths/flyover.txt)\n"
+      "  --warmup N          benchmark frames rendered before measuring (60)\n"
+      "  --timestep MS       benchmark simulation time step (16.667)\n"
+      "  --report PREFIX     benchmark report path without extension\n"
+      "                      (benchmark)\n"
+      "  --trace FILE        write the profiler zones to a Chrome trace on\n"
+      "                      exit (needs a GLGRASS_PROFILER build)\n"
+      "  --depth-prepass     draw the grass depth first, then shade only the\n"
+      "                      visible fragments\n"
+      "  --pipeline-statistics\n"
+      "                      count the shader invocations of the grass\n"
+      "                      (needs GL_ARB_pipeline_statistics_query)\n");
+}
+
+[[nodiscard]] int parse_positive(std::string_view text, std::string_view what)
+{
+  int value = 0;
+  const auto [end, error] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc{} || end != text.data() + text.size() || value <= 0) {
+    throw std::runtime_error{
+        fmt::format("Invalid {}: '{}', expected a positive integer", what,
+                    text)};
+  }
+  return value;
+}
+
+[[nodiscard]] double parse_milliseconds(std::string_view text)
+{
+  double value = 0;
+  const auto [end, error] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc{} || end != text.data() + text.size() || value <= 0) {
+    throw std::runtime_error{fmt::format(
+        "Invalid time step: '{}', expected milliseconds above 0", text)};
+  }
+  return value;
+}
+
+/// Returns nullopt when the usage was requested
+[[nodiscard]] std::optional<Options> parse_options(std::span<char*> args)
+{
+  Options options;
+  for (std::size_t i = 1; i < args.size(); ++i) {
+    const std::string_view arg = args[i];
+    const auto value = [&]() -> std::string_view {
+      if (i + 1 == args.size()) {
+        throw std::runtime_error{fmt::format("Missing value after {}", arg)};
+      }
+      return args[++i];
+    };
+
+    if (arg == "--help" || arg == "-h") {
+      return std::nullopt;
+    }
+    if (arg == "--headless") {
+      options.headless = true;
+    } else if (arg == "--frames") {
+      options.frames = parse_positive(value(), "frame count");
+    } else if (arg == "--size") {
+      const std::string_view size = value();
+      const auto x = size.find('x');
+      if (x == std::string_view::npos) {
+        throw std::runtime_error{
+            fmt::format("Invalid size: '{}', expected WIDTHxHEIGHT", size)};
+      }
+      options.width = parse_positive(size.substr(0, x), "width");
+      options.height = parse_positive(size.substr(x + 1), "height");
+    } else if (arg == "--benchmark") {
+      options.benchmark = true;
+    } else if (arg == "--camera-path") {
+      options.camera_path = value();
+    } else if (arg == "--warmup") {
+      options.warmup_frames = parse_positive(value(), "warmup frame count");
+    } else if (arg == "--timestep") {
+      options.timestep_ms = parse_milliseconds(value());
+    } else if (arg == "--report") {
+      options.report = value();
+    } else if (arg == "--trace") {
+      if (!Profiler::enabled) {
+        throw std::runtime_error{
+            "--trace needs a build with the profiler (GLGRASS_PROFILER)"};
+      }
+      options.trace = value();
+    } else if (arg == "--frames-in-flight") {
+      const int frames = parse_positive(value(), "frames in flight");
+      if (static_cast<std::size_t>(frames) > FramePacer::max_frames_in_flight) {
+        throw std::runtime_error{
+            fmt::format("Invalid frames in flight: {}, expected at most {}",
+                        frames, FramePacer::max_frames_in_flight)};
+      }
+      options.frames_in_flight = static_cast<std::size_t>(frames);
+    } else if (arg == "--depth-prepass") {
+      options.depth_prepass = true;
+    } else if (arg == "--pipeline-statistics") {
+      options.pipeline_statistics = true;
+    } else {
+      throw std::runtime_error{fmt::format("Unknown option: {}", arg)};
+    }
+  }
+  return options;
+}
+
 class App {
 public:
   using DeltaDuration = std::chrono::duration<double, std::milli>;
 
-  App(int width, int height, std::string_view title)
-      : width_{width}, height_{height}, delta_time_{}
+  // The passes timed on the CPU and on the GPU
+  enum Pass : std::size_t {
+    simulation_pass,
+    terrain_pass,
+    grass_depth_pass,
+    grass_pass,
+    skybox_pass,
+    gui_pass,
+    pass_count
+  };
+  static constexpr const char* pass_names[pass_count] = {
+      "simulation", "terrain", "grass_depth", "grass", "skybox", "gui"};
+
+  App(const Options& options, std::string_view title)
+      : options_{options}, width_{options.width}, height_{options.height},
+        delta_time_{}
   {
-    init_window(title);
-    load_gl();
+    PROFILE_ZONE("startup");
+    mount_asset_pack("assets.pack");
+    if (options.headless) {
+      headless_context_ = std::make_unique<HeadlessContext>();
+      load_gl(HeadlessContext::proc_loader());
+      offscreen_framebuffer_ =
+          std::make_unique<OffscreenFramebuffer>(width_, height_);
+    } else {
+      init_window(title);
+      load_gl(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
+    }
+    resources_ = std::make_unique<ResourceManager>(shader_watcher_);
+    frame_pacer_ = std::make_unique<FramePacer>(options.frames_in_flight);
+    gpu_timer_ = std::make_unique<GpuTimer>(
+        std::vector<std::string>(std::begin(pass_names), std::end(pass_names)),
+        options.frames_in_flight);
+    uploads_ = std::make_unique<UploadRing>(options.frames_in_flight);
+    if (options.pipeline_statistics) {
+      if (!gl_extensions().pipeline_statistics_query) {
+        throw std::runtime_error{"--pipeline-statistics needs OpenGL 4.6 or "
+                                 "GL_ARB_pipeline_statistics_query"};
+      }
+      pipeline_statistics_ =
+          std::make_unique<PipelineStatistics>(options.frames_in_flight);
+    }
 
-    init_imgui(window_);
+    init_imgui(window_.get());
 
     glEnable(GL_DEPTH_TEST);
 
     init_skybox();
-    init_terrain();
-    grasses_.init();
-    init_camera_uniform_buffer();
+    terrain_.init(*resources_);
+    grasses_.init(*resources_, options.frames_in_flight);
+    grasses_.depth_prepass = options.depth_prepass;
+    overdraw_heatmap_ = std::make_unique<OverdrawHeatmap>(*resources_);
+    build_frame_graph();
+  }
+
+  [[nodiscard]] bool headless() const noexcept
+  {
+    return window_ == nullptr;
   }
 
   void init_window(const std::string_view& title)
@@ -211,19 +394,20 @@ public:
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    window_ = glfwCreateWindow(width_, height_, title.data(), nullptr, nullptr);
+    window_.reset(
+        glfwCreateWindow(width_, height_, title.data(), nullptr, nullptr));
     if (window_ == nullptr) {
       fmt::print(stderr, "Failed to create GLFW window\n");
       glfwTerminate();
       exit(1);
     }
-    glfwMakeContextCurrent(window_);
-    glfwSetFramebufferSizeCallback(window_, framebuffer_size_callback);
-    glfwSetMouseButtonCallback(window_, mouse_button_callback);
-    glfwSetCursorPosCallback(window_, cursor_pos_callback);
-    glfwSetScrollCallback(window_, scroll_callback);
+    glfwMakeContextCurrent(window_.get());
+    glfwSetFramebufferSizeCallback(window_.get(), framebuffer_size_callback);
+    glfwSetMouseButtonCallback(window_.get(), mouse_button_callback);
+    glfwSetCursorPosCallback(window_.get(), cursor_pos_callback);
+    glfwSetScrollCallback(window_.get(), scroll_callback);
 
-    glfwSetWindowUserPointer(window_, this);
+    glfwSetWindowUserPointer(window_.get(), this);
 
     // tell GLFW to capture our mouse
     // glfwSetInputMode(window_, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -231,122 +415,560 @@ public:
 
   void init_skybox()
   {
-    skybox_texture_ = load_cubemap(
+    PROFILE_ZONE("init_skybox");
+    skybox_texture_ = resources_->load_cubemap(
+        "Skybox",
         {"textures/ely_hills/hills_rt.tga", "textures/ely_hills/hills_lf.tga",
          "textures/ely_hills/hills_up.tga", "textures/ely_hills/hills_dn.tga",
          "textures/ely_hills/hills_ft.tga", "textures/ely_hills/hills_bk.tga"});
 
-    glGenVertexArrays(1, &skybox_vao_);
-    glBindVertexArray(skybox_vao_);
-
     glDisable(GL_CULL_FACE);
 
-    unsigned int vbo = 0;
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizei>(sizeof(skybox_vertices)),
-                 skybox_vertices, GL_STATIC_DRAW);
+    skybox_vertex_buffer_ =
+        resources_->buffer("Skybox", "skybox_vertices",
+                           sizeof(skybox_vertices), skybox_vertices, 0);
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
-                          reinterpret_cast<void*>(0));
+    skybox_vertex_array_ = std::make_unique<VertexArray>();
+    skybox_vertex_array_->vertex_buffer(0, *skybox_vertex_buffer_, 0,
+                                        3 * sizeof(float));
+    skybox_vertex_array_->attribute(0, 0, 3, GL_FLOAT, 0);
 
-    skybox_shader_ = ShaderBuilder{}
-                         .load("skybox.vert.glsl", Shader::Type::Vertex)
-                         .load("skybox.frag.glsl", Shader::Type::Fragment)
-                         .build();
-
-    skybox_shader_.use();
-    skybox_shader_.setInt("skybox", 0);
+    skybox_shader_ = &resources_->program(
+        ShaderBuilder{}
+            .load("skybox.vert.glsl", Shader::Type::Vertex)
+            .load("skybox.frag.glsl", Shader::Type::Fragment)
+            .expect_layout(camera_buffer_layout));
   }
 
-  void init_terrain()
+  // All programs were submitted in the constructor. Keep the window
+  // responsive while the driver compiles them and defer the first frame until
+  // they are all linked. Textures keep streaming in meanwhile
+  void wait_for_shaders()
   {
-    terrain_model_ = generate_terrain_model();
-    terrain_shader_ = ShaderBuilder{}
-                          .load("land.vert.glsl", Shader::Type::Vertex)
-                          .load("land.frag.glsl", Shader::Type::Fragment)
-                          .build();
-    terrain_shader_.use();
-    terrain_shader_.setInt("texture1", 0);
+    PROFILE_ZONE("wait_for_shaders");
+    if (headless() || options_.benchmark) {
+      wait_for_resources();
+      return;
+    }
+
+    while (!resources_->programs_ready() &&
+           !glfwWindowShouldClose(window_.get())) {
+      resources_->update();
+      tile_streamer_.update(snapshot_.camera_position);
+      glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+      glClear(GL_COLOR_BUFFER_BIT);
+      glfwSwapBuffers(window_.get());
+      glfwPollEvents();
+    }
+
+    resources_->finalize_programs();
   }
 
-  void init_camera_uniform_buffer()
+  // Measured runs start with their first frame, so they also wait for the
+  // textures and for the tiles around the camera: every measured frame then
+  // renders the same scene
+  void wait_for_resources()
   {
-    glGenBuffers(1, &camera_uniform_buffer_);
-    glBindBuffer(GL_UNIFORM_BUFFER, camera_uniform_buffer_);
-    /*
-      mat4 view; // 64
-      mat4 proj; // 64
-      vec3 position; // 16
-    */
-    glBufferData(GL_UNIFORM_BUFFER, 140, nullptr, GL_STATIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, 0, camera_uniform_buffer_);
+    PROFILE_ZONE("wait_for_resources");
+    do {
+      resources_->update();
+      tile_streamer_.update(snapshot_.camera_position);
+      if (!headless()) {
+        glfwPollEvents();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    } while (!resources_->programs_ready() || !resources_->textures_idle());
+    tile_streamer_.flush(snapshot_.camera_position);
+
+    resources_->finalize_programs();
   }
 
   void run()
   {
+    std::optional<CameraPath> camera_path;
+    if (options_.benchmark) {
+      // Loaded first, so that a bad path fails before the long wait
+      const auto asset = load_asset(options_.camera_path);
+      if (!asset) {
+        throw std::runtime_error{
+            fmt::format("Camera path {} not found", options_.camera_path)};
+      }
+      camera_path = CameraPath::parse(asset->text());
+      set_camera_pose(camera_path->sample(0));
+    }
+
+    wait_for_shaders();
+    if (camera_path) {
+      run_benchmark(*camera_path);
+      return;
+    }
+    if (headless()) {
+      run_headless();
+      return;
+    }
+
+    SimulationThread simulation{simulation_, SimulationThread::default_rate};
     last_frame_ = std::chrono::steady_clock::now();
-    while (!glfwWindowShouldClose(window_)) {
+    while (!glfwWindowShouldClose(window_.get())) {
+      PROFILE_ZONE("frame");
+      // Waiting before the input is read keeps the latency to the frames in
+      // flight
+      frame_pacer_->begin_frame();
       const auto current_time = std::chrono::steady_clock::now();
       delta_time_ = current_time - last_frame_;
       last_frame_ = current_time;
 
-      process_input(window_);
+      shader_watcher_.poll();
+      resources_->update();
+      process_input(window_.get());
+      simulation.publish_input(input_);
+      snapshot_ = simulation.latest();
+      tile_streamer_.update(snapshot_.camera_position);
       render();
 
-      glfwSwapBuffers(window_);
+      {
+        PROFILE_ZONE("swap_buffers");
+        glfwSwapBuffers(window_.get());
+      }
       glfwPollEvents();
     }
   }
 
+  /// Renders a fixed number of frames offscreen and prints their timings
+  void run_headless()
+  {
+    std::vector<double> frame_times;
+    frame_times.reserve(static_cast<std::size_t>(options_.frames));
+
+    last_frame_ = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < options_.frames; ++frame) {
+      PROFILE_ZONE("frame");
+      frame_pacer_->begin_frame();
+      const auto frame_start = std::chrono::steady_clock::now();
+      delta_time_ = frame_start - last_frame_;
+      last_frame_ = frame_start;
+
+      shader_watcher_.poll();
+      resources_->update();
+      step_simulation(delta_time_);
+      tile_streamer_.update(snapshot_.camera_position);
+      render();
+      // Nothing throttles the loop like a swap does: wait for the GPU so
+      // that each frame time includes its GPU work
+      glFinish();
+
+      frame_times.push_back(
+          DeltaDuration{std::chrono::steady_clock::now() - frame_start}
+              .count());
+    }
+
+    const auto statistics = summarize_frame_times(frame_times);
+    fmt::print("{} frames at {}x{} on {}\n", statistics.frames, width_,
+               height_, renderer_name());
+    print_statistics("Frame time", statistics);
+    fmt::print("Total: {:.1f} ms, {:.1f} FPS\n", statistics.total,
+               1e3 * static_cast<double>(statistics.frames) /
+                   statistics.total);
+  }
+
+  /// Flies along `path` with a fixed time step, then writes the reports.
+  /// Tiles are streamed in between the frames, outside of the measurements,
+  /// so that every run renders the same tiles on the same frames
+  void run_benchmark(const CameraPath& path)
+  {
+    if (!headless()) {
+      glfwSwapInterval(0);
+    }
+    delta_time_ = DeltaDuration{options_.timestep_ms};
+
+    std::vector<std::string> metrics{"frame_ms", "cpu_ms", "gpu_ms"};
+    for (const char* name : pass_names) {
+      metrics.push_back(fmt::format("cpu_{}_ms", name));
+    }
+    for (const char* name : pass_names) {
+      metrics.push_back(fmt::format("gpu_{}_ms", name));
+    }
+    metrics.insert(metrics.end(),
+                   {"blades_drawn", "blades_frustum_culled",
+                    "blades_distance_culled", "patches_near_lod",
+                    "patches_far_lod"});
+    if (pipeline_statistics_ != nullptr) {
+      metrics.insert(metrics.end(),
+                     std::begin(PipelineStatistics::counter_names),
+                     std::end(PipelineStatistics::counter_names));
+    }
+    BenchmarkReport report{std::move(metrics)};
+    GLuint gpu_query = 0;
+    glGenQueries(1, &gpu_query);
+
+    // The per-pass GPU times and the blade statistics of a frame are
+    // resolved a few frames later, so the rows are completed once the run is
+    // over
+    std::vector<std::pair<std::uint64_t, std::vector<double>>> rows;
+    std::unordered_map<std::uint64_t, std::vector<double>> gpu_pass_times;
+    std::unordered_map<std::uint64_t, Grasses::Statistics> blade_statistics;
+    std::unordered_map<std::uint64_t, PipelineStatistics::FrameCounts>
+        pipeline_counts;
+    const auto take_gpu_pass_times = [&] {
+      for (auto& times : gpu_timer_->take_resolved()) {
+        gpu_pass_times.emplace(times.frame, std::move(times.pass_ms));
+      }
+      for (const auto& statistics : grasses_.take_statistics()) {
+        blade_statistics.emplace(statistics.frame, statistics);
+      }
+      if (pipeline_statistics_ != nullptr) {
+        for (const auto& counts : pipeline_statistics_->take_resolved()) {
+          pipeline_counts.emplace(counts.frame, counts);
+        }
+      }
+    };
+    (void)gpu_timer_->take_resolved();
+    (void)grasses_.take_statistics();
+    if (pipeline_statistics_ != nullptr) {
+      (void)pipeline_statistics_->take_resolved();
+    }
+
+    const int frame_count = options_.warmup_frames + options_.frames;
+    for (int frame = 0; frame < frame_count; ++frame) {
+      if (!headless() && glfwWindowShouldClose(window_.get())) {
+        break;
+      }
+      PROFILE_ZONE("frame");
+      set_camera_pose(path.sample(static_cast<float>(
+          frame * options_.timestep_ms / 1e3)));
+      step_simulation(delta_time_);
+      tile_streamer_.flush(snapshot_.camera_position);
+
+      frame_pacer_->begin_frame();
+      const auto frame_start = std::chrono::steady_clock::now();
+      glBeginQuery(GL_TIME_ELAPSED, gpu_query);
+      render();
+      glEndQuery(GL_TIME_ELAPSED);
+      const auto submitted = std::chrono::steady_clock::now();
+      if (!headless()) {
+        glfwSwapBuffers(window_.get());
+        glfwPollEvents();
+      }
+      glFinish();
+      const auto frame_end = std::chrono::steady_clock::now();
+
+      GLuint64 gpu_time = 0;
+      glGetQueryObjectui64v(gpu_query, GL_QUERY_RESULT, &gpu_time);
+      take_gpu_pass_times();
+      if (frame < options_.warmup_frames) {
+        continue;
+      }
+      std::vector<double> values{
+          DeltaDuration{frame_end - frame_start}.count(),
+          DeltaDuration{submitted - frame_start}.count(),
+          static_cast<double>(gpu_time) / 1e6};
+      values.insert(values.end(), cpu_pass_ms_.begin(), cpu_pass_ms_.end());
+      rows.emplace_back(gpu_timer_->frame(), std::move(values));
+    }
+    glDeleteQueries(1, &gpu_query);
+
+    gpu_timer_->flush();
+    grasses_.flush_statistics();
+    if (pipeline_statistics_ != nullptr) {
+      pipeline_statistics_->flush();
+    }
+    take_gpu_pass_times();
+    for (auto& [gpu_frame, values] : rows) {
+      const auto times = gpu_pass_times.find(gpu_frame);
+      for (std::size_t pass = 0; pass < pass_count; ++pass) {
+        values.push_back(times != gpu_pass_times.end() ? times->second[pass]
+                                                       : 0.0);
+      }
+      const auto statistics = blade_statistics.find(gpu_frame);
+      const Grasses::Statistics resolved =
+          statistics != blade_statistics.end() ? statistics->second
+                                               : Grasses::Statistics{};
+      values.insert(values.end(),
+                    {static_cast<double>(resolved.drawn_blades),
+                     static_cast<double>(resolved.counts.frustum_culled),
+                     static_cast<double>(resolved.counts.distance_culled),
+                     static_cast<double>(resolved.counts.near_lod_patches),
+                     static_cast<double>(resolved.counts.far_lod_patches)});
+      if (pipeline_statistics_ != nullptr) {
+        const auto counts = pipeline_counts.find(gpu_frame);
+        for (std::size_t counter = 0;
+             counter < PipelineStatistics::counter_count; ++counter) {
+          values.push_back(
+              counts != pipeline_counts.end()
+                  ? static_cast<double>(counts->second.counts[counter])
+                  : 0.0);
+        }
+      }
+      report.add_frame(values);
+    }
+
+    fmt::print("Benchmark: {} frames at {}x{} on {}\n",
+               report.statistics(0).frames, width_, height_, renderer_name());
+    for (std::size_t i = 0; i < report.metrics().size(); ++i) {
+      print_statistics(report.metrics()[i], report.statistics(i));
+    }
+
+    const BenchmarkInfo info{renderer_name(),         options_.camera_path,
+                             width_,                  height_,
+                             options_.warmup_frames, options_.timestep_ms};
+    report.write_json(options_.report + ".json", info);
+    report.write_csv(options_.report + ".csv");
+    fmt::print("Wrote {0}.json and {0}.csv\n", options_.report);
+  }
+
+  static void print_statistics(std::string_view name,
+                               const FrameStatistics& statistics)
+  {
+    // The benchmark metrics are times in milliseconds, or counts
+    const std::string_view unit =
+        name.ends_with("_ms") || name == "Frame time" ? " ms" : "";
+    fmt::print("{}: mean {:.3f}{unit}, min {:.3f}{unit}, p50 {:.3f}{unit}, "
+               "p95 {:.3f}{unit}, p99 {:.3f}{unit}, max {:.3f}{unit}\n",
+               name, statistics.mean, statistics.min, statistics.p50,
+               statistics.p95, statistics.p99, statistics.max,
+               fmt::arg("unit", unit));
+  }
+
+  [[nodiscard]] static std::string renderer_name()
+  {
+    return reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+  }
+
+  void set_camera_pose(const CameraKeyframe& pose)
+  {
+    simulation_.camera().set_pose(pose.position, pose.yaw, pose.pitch);
+    snapshot_ = simulation_.snapshot();
+  }
+
+  /// Steps the simulation on this thread, for the measured runs which need
+  /// every frame to render its own step
+  void step_simulation(DeltaDuration delta_time)
+  {
+    simulation_.step(input_, delta_time);
+    snapshot_ = simulation_.snapshot();
+  }
+
   void render()
   {
+    cpu_pass_ms_ = {};
+    gl_calls_ = gl_state().take_counters();
+    gpu_timer_->begin_frame(frame_pacer_->slot());
+    if (pipeline_statistics_ != nullptr) {
+      pipeline_statistics_->begin_frame(frame_pacer_->slot(),
+                                        gpu_timer_->frame());
+    }
+    uploads_->begin_frame(frame_pacer_->slot());
+    if (offscreen_framebuffer_ != nullptr) {
+      offscreen_framebuffer_->bind();
+    }
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    draw_gui();
+    // Building the GUI issues no GL commands, only its CPU time counts
+    time_pass(gui_pass, [this] { draw_gui(); });
     render_scene();
 
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    run_pass(gui_pass, [] {
+      ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    });
+    frame_pacer_->end_frame();
   }
 
-  void render_scene()
+  /// Runs `draw` and adds its CPU time to `pass`
+  template <typename Draw> void time_pass(Pass pass, Draw draw)
   {
-    // camera/view transformation
-    glm::vec3 position = camera_.position();
-    glm::mat4 view = camera_.view_matrix();
-    glm::mat4 projection = glm::perspective(
-        glm::radians(camera_.zoom()),
-        static_cast<float>(width_) / static_cast<float>(height_), 0.1f, 100.0f);
-    glBindBufferBase(GL_UNIFORM_BUFFER, 0, camera_uniform_buffer_);
-    glBindBuffer(GL_UNIFORM_BUFFER, camera_uniform_buffer_);
+    const auto start = std::chrono::steady_clock::now();
+    draw();
+    cpu_pass_ms_[pass] +=
+        DeltaDuration{std::chrono::steady_clock::now() - start}.count();
+  }
 
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, 64, &view);
-    glBufferSubData(GL_UNIFORM_BUFFER, 64, 64, &projection);
-    glBufferSubData(GL_UNIFORM_BUFFER, 128, 12, &position);
+  /// Runs `draw` as `pass`, timed on the CPU and on the GPU
+  template <typename Draw> void run_pass(Pass pass, Draw draw)
+  {
+    gpu_timer_->begin(pass);
+    time_pass(pass, draw);
+    gpu_timer_->end(pass);
+  }
 
-    grasses_.update(delta_time_);
+  /// Runs `work` inside the pipeline statistics queries of `stage`, when
+  /// they are collected
+  template <typename Work>
+  void count_invocations(PipelineStatistics::Stage stage, Work work)
+  {
+    if (pipeline_statistics_ == nullptr) {
+      work();
+      return;
+    }
+    pipeline_statistics_->begin(stage);
+    work();
+    pipeline_statistics_->end(stage);
+  }
 
-    // Skybox
-    glDepthMask(GL_FALSE);
-    skybox_shader_.use();
-    glBindVertexArray(skybox_vao_);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, skybox_texture_);
+  void render_scene()
+  {
+    PROFILE_ZONE("render_scene");
+    update_uniforms();
+    frame_graph_.execute();
+  }
 
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-    glDepthMask(GL_TRUE);
+  /// Declares the scene passes in the order their effects must appear in. The
+  /// graph runs the culling as early as it can, and places its barriers.
+  /// Rebuilt when the grass debug view or depth prepass changes, which add
+  /// passes
+  void build_frame_graph()
+  {
+    const bool overdraw =
+        grasses_.debug_view == Grasses::DebugView::overdraw;
+    using Access = RenderGraph::Access;
+    using Queue = RenderGraph::Queue;
+    RenderGraph& graph = frame_graph_;
+    const auto blades = graph.resource("blades");
+    const auto grass_tiles = graph.resource("grass tiles");
+    const auto culled_blades = graph.resource("culled blades");
+    const auto draw_command = graph.resource("grass draw command");
+    const auto heightmaps = graph.resource("heightmaps");
+    const auto terrain_tiles = graph.resource("terrain tiles");
+    const auto backbuffer = graph.resource("backbuffer");
+    const auto blade_statistics = graph.resource("blade statistics");
+    const auto statistics_readback = graph.resource("statistics readback");
+    const auto overdraw_counts = graph.resource("overdraw counts");
+    graph.output(backbuffer);
+    graph.output(statistics_readback);
+
+    graph
+        .add_pass(pass_names[simulation_pass], Queue::compute,
+                  [this] {
+                    run_pass(simulation_pass, [this] {
+                      count_invocations(PipelineStatistics::compute, [this] {
+                        grasses_.update(simulation_uniforms_, *uploads_);
+                      });
+                    });
+                  })
+        .read(blades, Access::shader_storage)
+        .write(blades, Access::shader_storage)
+        .read(grass_tiles, Access::shader_storage)
+        .write(grass_tiles, Access::buffer_update)
+        .write(culled_blades, Access::shader_storage)
+        .write(draw_command, Access::buffer_update)
+        .write(draw_command, Access::shader_storage)
+        .write(blade_statistics, Access::buffer_update)
+        .write(blade_statistics, Access::shader_storage);
+
+    graph
+        .add_pass(pass_names[terrain_pass], Queue::graphics,
+                  [this] {
+                    run_pass(terrain_pass, [this] { terrain_.render(); });
+                  })
+        .read(heightmaps, Access::texture_fetch)
+        .read(terrain_tiles, Access::shader_storage)
+        .write(backbuffer, Access::framebuffer);
+
+    if (grasses_.depth_prepass) {
+      graph
+          .add_pass(pass_names[grass_depth_pass], Queue::graphics,
+                    [this] {
+                      run_pass(grass_depth_pass,
+                               [this] { grasses_.render_depth(); });
+                    })
+          .read(culled_blades, Access::vertex_attribute)
+          .read(draw_command, Access::indirect_command)
+          .write(backbuffer, Access::framebuffer);
+    }
 
-    // Terrain
-    terrain_shader_.use();
-    terrain_model_->render();
+    RenderGraph::Pass& grass =
+        graph
+            .add_pass(pass_names[grass_pass], Queue::graphics,
+                      [this, overdraw] {
+                        if (overdraw) {
+                          overdraw_heatmap_->bind();
+                        }
+                        run_pass(grass_pass, [this] {
+                          count_invocations(PipelineStatistics::draw,
+                                            [this] { grasses_.render(); });
+                        });
+                      })
+            .read(culled_blades, Access::vertex_attribute)
+            .read(draw_command, Access::indirect_command)
+            .write(backbuffer, Access::framebuffer);
+    if (overdraw) {
+      grass.write(overdraw_counts, Access::shader_image);
+
+      graph
+          .add_pass("overdraw", Queue::graphics,
+                    [this] { overdraw_heatmap_->resolve(); })
+          .read(overdraw_counts, Access::shader_image)
+          .write(overdraw_counts, Access::shader_image)
+          .write(backbuffer, Access::framebuffer);
+    }
 
-    grasses_.render();
+    // Last of the opaque geometry, at the far plane, so that only the pixels
+    // nothing covers shade the sky
+    graph
+        .add_pass(pass_names[skybox_pass], Queue::graphics,
+                  [this] {
+                    run_pass(skybox_pass, [this] {
+                      glDepthMask(GL_FALSE);
+                      glDepthFunc(GL_LEQUAL);
+                      skybox_shader_->use();
+                      skybox_vertex_array_->bind();
+                      gl_state().bind_texture_unit(0, skybox_texture_.id());
+
+                      glDrawArrays(GL_TRIANGLES, 0, 36);
+                      glDepthFunc(GL_LESS);
+                      glDepthMask(GL_TRUE);
+                    });
+                  })
+        .write(backbuffer, Access::framebuffer);
+
+    graph
+        .add_pass("statistics", Queue::graphics,
+                  [this] {
+                    grasses_.read_back_statistics(frame_pacer_->slot(),
+                                                  gpu_timer_->frame());
+                  })
+        .read(blade_statistics, Access::buffer_update)
+        .read(draw_command, Access::buffer_update)
+        .write(statistics_readback, Access::buffer_update);
+
+    graph.compile();
+  }
+
+  void update_uniforms()
+  {
+    PROFILE_ZONE("update_uniforms");
+    // camera/view transformation
+    CameraBufferObject camera;
+    camera.view = snapshot_.view;
+    camera.proj = glm::perspective(
+        glm::radians(snapshot_.zoom),
+        static_cast<float>(width_) / static_cast<float>(height_), 0.1f, 100.0f);
+    camera.position = snapshot_.camera_position;
+    uploads_->bind_uniforms(0, camera);
+
+    terrain_.bind(*uploads_);
+
+    // The blades advance by the time simulated since the last frame, none
+    // when the simulation has not stepped since
+    simulation_uniforms_ = {snapshot_.time,
+                            snapshot_.time - simulation_uniforms_.current_time,
+                            snapshot_.wind_magnitude,
+                            snapshot_.wind_wave_length,
+                            snapshot_.wind_wave_period};
   }
 
   void draw_gui()
   {
+    PROFILE_ZONE("draw_gui");
     ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+    if (headless()) {
+      ImGuiIO& io = ImGui::GetIO();
+      io.DisplaySize =
+          ImVec2(static_cast<float>(width_), static_cast<float>(height_));
+      io.DeltaTime =
+          std::max(static_cast<float>(delta_time_.count() / 1e3), 1e-6f);
+    } else {
+      ImGui_ImplGlfw_NewFrame();
+    }
     ImGui::NewFrame();
 
     ImGui::Begin("Control");
@@ -354,17 +976,79 @@ public:
     ImGui::Text("%.3f ms/frame (%.1f FPS)", delta_time_.count(),
                 1000.f / delta_time_.count());
 
-    static float camera_speed = camera_.speed();
-    ImGui::SliderFloat("Camera Speed", &camera_speed, 0.5, 30, "%.4f", 2.0f);
-    camera_.set_speed(camera_speed);
+    if (ImGui::CollapsingHeader("GPU Passes",
+                                ImGuiTreeNodeFlags_DefaultOpen)) {
+      draw_gpu_pass_times();
+    }
+
+    if (pipeline_statistics_ != nullptr &&
+        ImGui::CollapsingHeader("Pipeline Statistics")) {
+      draw_pipeline_statistics();
+    }
+
+    if (ImGui::CollapsingHeader("Frame Graph")) {
+      draw_frame_graph();
+    }
+
+    if (Profiler::enabled && ImGui::CollapsingHeader("Profiler")) {
+      draw_profiler();
+    }
+
+    ImGui::SliderFloat("Camera Speed", &input_.camera_speed, 0.5, 30, "%.4f",
+                       2.0f);
 
     if (ImGui::CollapsingHeader("Wind")) {
-      ImGui::SliderFloat("Magnitude", &grasses_.wind_magnitude, 0.5f, 3,
-                         "%.4f");
-      ImGui::SliderFloat("Wave Length", &grasses_.wind_wave_length, 0.5f, 2,
+      ImGui::SliderFloat("Magnitude", &input_.wind_magnitude, 0.5f, 3, "%.4f");
+      ImGui::SliderFloat("Wave Length", &input_.wind_wave_length, 0.5f, 2,
                          "%.4f");
-      ImGui::SliderFloat("Wave Period", &grasses_.wind_wave_period, 0.5f, 2,
+      ImGui::SliderFloat("Wave Period", &input_.wind_wave_period, 0.5f, 2,
                          "%.4f");
+      ImGui::Text("Simulated %.1f s in %llu steps",
+                  static_cast<double>(snapshot_.time),
+                  static_cast<unsigned long long>(snapshot_.step));
+    }
+
+    if (ImGui::CollapsingHeader("Terrain")) {
+      ImGui::SliderFloat("Tessellation", &terrain_.tessellation_factor, 1, 64,
+                         "%.1f");
+      int patches = static_cast<int>(terrain_.patches_per_side);
+      ImGui::SliderInt("Patches per Tile Side", &patches, 1, 16);
+      terrain_.patches_per_side = static_cast<GLuint>(patches);
+      ImGui::Checkbox("Wireframe", &terrain_.wireframe);
+
+      const auto stats = tile_streamer_.stats();
+      ImGui::Text("Tiles: %zu terrain, %zu grass, %zu pending",
+                  stats.terrain_tiles, stats.grass_tiles, stats.pending_tiles);
+    }
+
+    if (ImGui::CollapsingHeader("Compute Shader")) {
+      ImGui::Checkbox("Culling", &grasses_.culling);
+      if (ImGui::BeginCombo("Workgroup Size",
+                            fmt::to_string(grasses_.workgroup_size).c_str())) {
+        for (const GLuint size : Grasses::workgroup_sizes) {
+          if (ImGui::Selectable(fmt::to_string(size).c_str(),
+                                size == grasses_.workgroup_size)) {
+            grasses_.workgroup_size = size;
+          }
+        }
+        ImGui::EndCombo();
+      }
+      draw_blade_statistics();
+    }
+
+    if (ImGui::CollapsingHeader("Grass Shading")) {
+      if (ImGui::Checkbox("Depth Prepass", &grasses_.depth_prepass)) {
+        frame_graph_ = RenderGraph{};
+        build_frame_graph();
+      }
+    }
+
+    if (ImGui::CollapsingHeader("Debug View")) {
+      draw_debug_views();
+    }
+
+    if (ImGui::CollapsingHeader("GPU Memory")) {
+      draw_memory_usage();
     }
 
     ImGui::End();
@@ -372,11 +1056,136 @@ public:
     ImGui::Render();
   }
 
+  void draw_debug_views()
+  {
+    for (std::size_t i = 0; i < std::size(Grasses::debug_view_names); ++i) {
+      const auto view = static_cast<Grasses::DebugView>(i);
+      if (ImGui::RadioButton(Grasses::debug_view_names[i],
+                             grasses_.debug_view == view) &&
+          grasses_.debug_view != view) {
+        grasses_.debug_view = view;
+        frame_graph_ = RenderGraph{};
+        build_frame_graph();
+      }
+    }
+    switch (grasses_.debug_view) {
+    case Grasses::DebugView::none:
+      break;
+    case Grasses::DebugView::overdraw:
+      ImGui::TextWrapped("Grass fragments shaded per pixel, blue for one, "
+                         "red for 16 and more");
+      break;
+    case Grasses::DebugView::lod:
+      ImGui::TextWrapped("Tessellation level of the blades, blue far, red "
+                         "near");
+      break;
+    case Grasses::DebugView::cull_reason:
+      ImGui::TextWrapped("Culled blades are drawn too: magenta outside the "
+                         "frustum, orange too far, grey kept");
+      break;
+    }
+  }
+
+  void draw_blade_statistics()
+  {
+    const Grasses::Statistics& statistics = grasses_.statistics();
+    const GrassStatistics& counts = statistics.counts;
+    ImGui::Text("Resident blades: %u", counts.resident_blades);
+    ImGui::Text("Frustum culled: %u", counts.frustum_culled);
+    ImGui::Text("Distance culled: %u", counts.distance_culled);
+    ImGui::Text("Drawn blades: %u", statistics.drawn_blades);
+    ImGui::Text("LOD patches: %u near, %u far", counts.near_lod_patches,
+                counts.far_lod_patches);
+    ImGui::Text("Read back %llu frames late",
+                static_cast<unsigned long long>(gpu_timer_->frame() -
+                                                statistics.frame));
+  }
+
+  void draw_gpu_pass_times()
+  {
+    double total = 0;
+    for (std::size_t pass = 0; pass < pass_count; ++pass) {
+      const double milliseconds = gpu_timer_->average(pass);
+      ImGui::Text("%s: %.3f ms", pass_names[pass], milliseconds);
+      total += milliseconds;
+    }
+    ImGui::Text("Total: %.3f ms (mean of %zu frames)", total,
+                GpuTimer::history_size);
+    if (gpu_timer_->dropped_frames() > 0) {
+      ImGui::Text("%zu frames dropped", gpu_timer_->dropped_frames());
+    }
+    ImGui::Text("State changes: %zu issued, %zu redundant elided",
+                gl_calls_.issued, gl_calls_.elided);
+    ImGui::Text("%zu frames in flight, waited %.3f ms (%zu stalls)",
+                frame_pacer_->frames_in_flight(), frame_pacer_->wait_ms(),
+                frame_pacer_->stalls());
+  }
+
+  void draw_pipeline_statistics()
+  {
+    const PipelineStatistics::FrameCounts& latest =
+        pipeline_statistics_->latest();
+    for (std::size_t counter = 0; counter < PipelineStatistics::counter_count;
+         ++counter) {
+      ImGui::Text("%s: %llu", PipelineStatistics::counter_names[counter],
+                  static_cast<unsigned long long>(latest.counts[counter]));
+    }
+    if (pipeline_statistics_->dropped_frames() > 0) {
+      ImGui::Text("%zu frames dropped", pipeline_statistics_->dropped_frames());
+    }
+  }
+
+  void draw_frame_graph()
+  {
+    const auto& schedule = frame_graph_.schedule();
+    for (const RenderGraph::Step& step : schedule) {
+      if (step.barriers != 0) {
+        ImGui::TextDisabled("barrier: %s",
+                            barrier_names(step.barriers).c_str());
+      }
+      ImGui::Text("%s", std::string{frame_graph_.pass_name(step.pass)}.c_str());
+    }
+    ImGui::Text("%zu passes culled",
+                frame_graph_.pass_count() - schedule.size());
+  }
+
+  void draw_profiler()
+  {
+    const std::string path =
+        options_.trace.empty() ? "trace.json" : options_.trace;
+    if (ImGui::Button("Write Trace")) {
+      try {
+        Profiler::write_chrome_trace(path);
+        trace_status_ = fmt::format("Wrote {}", path);
+      } catch (const std::exception& e) {
+        trace_status_ = e.what();
+      }
+    }
+    ImGui::SameLine();
+    ImGui::Text("%s", trace_status_.empty() ? path.c_str()
+                                            : trace_status_.c_str());
+  }
+
+  void draw_memory_usage()
+  {
+    constexpr auto mib = [](std::size_t bytes) {
+      return static_cast<double>(bytes) / (1 << 20);
+    };
+
+    std::size_t total = 0;
+    for (const auto& usage : resources_->memory_usage()) {
+      ImGui::Text("%s: %zu textures %.2f MiB, %zu buffers %.2f MiB",
+                  usage.subsystem.c_str(), usage.texture_count,
+                  mib(usage.texture_bytes), usage.buffer_count,
+                  mib(usage.buffer_bytes));
+      total += usage.texture_bytes + usage.buffer_bytes;
+    }
+    ImGui::Text("Total: %.2f MiB", mib(total));
+  }
+
   ~App()
   {
-    destroy_imgui();
-    glfwDestroyWindow(window_);
-    glfwTerminate();
+    destroy_imgui(!headless());
   }
 
   App(const App& app) = delete;
@@ -384,14 +1193,10 @@ public:
   App(App&& app) = delete;
   App& operator=(App&& app) = delete;
 
-  [[nodiscard]] Camera& camera() noexcept
+  /// Gathered on the window thread, published to the simulation each frame
+  [[nodiscard]] SimulationInput& input() noexcept
   {
-    return camera_;
-  }
-
-  [[nodiscard]] DeltaDuration delta_time() const noexcept
-  {
-    return delta_time_;
+    return input_;
   }
 
   [[nodiscard]] int width() const noexcept
@@ -415,63 +1220,94 @@ public:
   }
 
 private:
-  GLFWwindow* window_ = nullptr;
+  // Declared first so that the context outlives every GL object below
+  std::unique_ptr<GLFWwindow, WindowDeleter> window_;
+  std::unique_ptr<HeadlessContext> headless_context_;
+  std::unique_ptr<OffscreenFramebuffer> offscreen_framebuffer_;
+  Options options_;
   int width_ = 0;
   int height_ = 0;
 
   bool right_clicking_ = false;
 
-  std::unique_ptr<Mesh> terrain_model_;
-  ShaderProgram terrain_shader_{};
+  ShaderWatcher shader_watcher_;
+  std::unique_ptr<ResourceManager> resources_;
+
+  Terrain terrain_;
 
   Grasses grasses_;
 
-  ShaderProgram skybox_shader_{};
-  unsigned int skybox_vao_ = 0;
+  TileStreamer tile_streamer_{terrain_, grasses_};
 
-  unsigned int camera_uniform_buffer_ = 0;
+  ShaderProgram* skybox_shader_ = nullptr;
+  std::unique_ptr<VertexArray> skybox_vertex_array_;
+  std::shared_ptr<Buffer> skybox_vertex_buffer_;
 
-  // camera
-  Camera camera_{glm::vec3(0.0f, 1.0f, 6.0f)};
+
+  // Stepped by a SimulationThread in interactive mode, on this thread in the
+  // measured runs
+  Simulation simulation_{Camera{glm::vec3(0.0f, 6.0f, 6.0f)}};
+  SimulationInput input_;
+  /// The state rendered this frame
+  SimulationSnapshot snapshot_ = simulation_.snapshot();
+  SimulationBufferObject simulation_uniforms_;
 
   DeltaDuration delta_time_;
   std::chrono::steady_clock::time_point last_frame_;
 
-  unsigned int skybox_texture_ = 0;
+  std::unique_ptr<FramePacer> frame_pacer_;
+  std::unique_ptr<GpuTimer> gpu_timer_;
+  /// Null unless requested with --pipeline-statistics
+  std::unique_ptr<PipelineStatistics> pipeline_statistics_;
+  std::unique_ptr<OverdrawHeatmap> overdraw_heatmap_;
+  std::unique_ptr<UploadRing> uploads_;
+  RenderGraph frame_graph_;
+  // CPU time spent submitting each pass of the last frame, in milliseconds
+  std::array<double, pass_count> cpu_pass_ms_{};
+  /// The binds of the previous frame
+  GLState::Counters gl_calls_;
+  std::string trace_status_;
+
+  TextureHandle skybox_texture_;
 };
 
-int main()
+int main(int argc, char** argv)
 try {
-  App app(1920, 1080, "Grass Renderer");
+  const auto options =
+      parse_options(std::span{argv, static_cast<std::size_t>(argc)});
+  if (!options) {
+    print_usage();
+    return 0;
+  }
+  PROFILE_THREAD("main");
+  App app(*options, "Grass Renderer");
   app.run();
+  if (!options->trace.empty()) {
+    Profiler::write_chrome_trace(options->trace);
+    fmt::print("Trace written to {}\n", options->trace);
+  }
 } catch (const std::exception& e) {
   fmt::print(stderr, "Error: {}\n", e.what());
+  return 1;
 } catch (...) {
   fmt::print(stderr, "Unknown exception!\n");
+  return 1;
 }
 
 void process_input(GLFWwindow* window)
 {
+  PROFILE_ZONE("process_input");
   auto* app_ptr = reinterpret_cast<App*>(glfwGetWindowUserPointer(window));
-  auto& camera = app_ptr->camera();
-  const auto delta_time = app_ptr->delta_time();
+  auto& input = app_ptr->input();
 
   if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
     glfwSetWindowShouldClose(window, true);
   }
 
-  if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-    camera.move(Camera::Movement::forward, delta_time);
-  }
-  if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-    camera.move(Camera::Movement::backward, delta_time);
-  }
-  if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-    camera.move(Camera::Movement::left, delta_time);
-  }
-  if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-    camera.move(Camera::Movement::right, delta_time);
-  }
+  input.forward = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS;
+  input.backward = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS;
+  input.left = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
+  input.right = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback
@@ -487,7 +1323,6 @@ void framebuffer_size_callback(GLFWwindow* /*window*/, int width, int height)
 void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos)
 {
   auto* app_ptr = reinterpret_cast<App*>(glfwGetWindowUserPointer(window));
-  auto& camera = app_ptr->camera();
   const auto f_width = static_cast<float>(app_ptr->width());
   const auto f_height = static_cast<float>(app_ptr->height());
 
@@ -509,7 +1344,7 @@ void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos)
   lastY = static_cast<float>(ypos);
 
   if (app_ptr->right_clicking()) {
-    camera.mouse_movement(xoffset, yoffset);
+    app_ptr->input().look += glm::vec2{xoffset, yoffset};
   }
 }
 
@@ -533,7 +1368,5 @@ void mouse_button_callback(GLFWwindow* window, int button, int action,
 void scroll_callback(GLFWwindow* window, double /*xoffset*/, double yoffset)
 {
   auto* app_ptr = reinterpret_cast<App*>(glfwGetWindowUserPointer(window));
-  auto& camera = app_ptr->camera();
-
-  camera.mouse_scroll(static_cast<float>(yoffset));
+  app_ptr->input().scroll += static_cast<float>(yoffset);
 }
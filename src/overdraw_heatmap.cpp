@@ -0,0 +1,49 @@
+#include "overdraw_heatmap.hpp"
+#include "gl_extensions.hpp"
+
+#include <array>
+#include <vector>
+
+OverdrawHeatmap::OverdrawHeatmap(ResourceManager& resources)
+    : resources_{&resources}
+{
+  (void)resources.program(resolve_shader_builder());
+}
+
+void OverdrawHeatmap::bind()
+{
+  std::array<GLint, 4> viewport{};
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+  if (viewport[2] != width_ || viewport[3] != height_) {
+    width_ = viewport[2];
+    height_ = viewport[3];
+    counts_ = Texture{GL_TEXTURE_2D};
+    glTextureStorage2D(counts_.id(), 1, GL_R32UI, width_, height_);
+    const std::vector<GLuint> zeros(
+        static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_));
+    glTextureSubImage2D(counts_.id(), 0, 0, 0, width_, height_,
+                        GL_RED_INTEGER, GL_UNSIGNED_INT, zeros.data());
+  }
+  glBindImageTexture(image_unit, counts_.id(), 0, GL_FALSE, 0, GL_READ_WRITE,
+                     GL_R32UI);
+}
+
+void OverdrawHeatmap::resolve()
+{
+  ShaderProgram& shader = resources_->program(resolve_shader_builder());
+  shader.finalize();
+  shader.use();
+  vertex_array_.bind();
+
+  // Every pixel runs the shader, which clears the counts behind it
+  glDisable(GL_DEPTH_TEST);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glEnable(GL_DEPTH_TEST);
+}
+
+ShaderBuilder OverdrawHeatmap::resolve_shader_builder()
+{
+  return ShaderBuilder{}
+      .load("overdraw.vert.glsl", Shader::Type::Vertex)
+      .load("overdraw.frag.glsl", Shader::Type::Fragment);
+}
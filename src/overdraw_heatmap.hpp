@@ -0,0 +1,44 @@
+#ifndef GLGRASSRENDERER_OVERDRAW_HEATMAP_HPP
+#define GLGRASSRENDERER_OVERDRAW_HEATMAP_HPP
+
+#include "gl_objects.hpp"
+#include "resource_manager.hpp"
+#include "shader.hpp"
+
+#include <glad/glad.h>
+
+/**
+ * @brief Shows how many fragments were shaded on each pixel
+ *
+ * Integer render targets cannot blend, so the fragment shaders count into an
+ * R32UI image with imageAtomicAdd() instead of adding up with blending.
+ * resolve() then draws the counts over the frame as a heatmap, and clears
+ * them for the next frame in the same pass.
+ */
+class OverdrawHeatmap {
+public:
+  /// The image unit the counting shaders declare the counts at
+  static constexpr GLuint image_unit = 0;
+
+  /// `resources` must outlive the heatmap
+  explicit OverdrawHeatmap(ResourceManager& resources);
+
+  /// Binds the counts to image_unit, sized to the current viewport. They
+  /// start at 0 whenever the size changes
+  void bind();
+  /// Draws the counts over the framebuffer, leaving the pixels without any
+  /// fragment as they are. Needs a shader image access barrier after the
+  /// counting
+  void resolve();
+
+private:
+  ResourceManager* resources_ = nullptr;
+  Texture counts_;
+  GLsizei width_ = 0;
+  GLsizei height_ = 0;
+  VertexArray vertex_array_;
+
+  [[nodiscard]] static ShaderBuilder resolve_shader_builder();
+};
+
+#endif // GLGRASSRENDERER_OVERDRAW_HEATMAP_HPP
@@ -0,0 +1,131 @@
+#include "pipeline_statistics.hpp"
+#include "gl_extensions.hpp"
+
+namespace {
+
+constexpr GLenum counter_targets[PipelineStatistics::counter_count] = {
+    GL_VERTEX_SHADER_INVOCATIONS_ARB,
+    GL_TESS_CONTROL_SHADER_PATCHES_ARB,
+    GL_TESS_EVALUATION_SHADER_INVOCATIONS_ARB,
+    GL_CLIPPING_INPUT_PRIMITIVES_ARB,
+    GL_CLIPPING_OUTPUT_PRIMITIVES_ARB,
+    GL_FRAGMENT_SHADER_INVOCATIONS_ARB,
+    GL_COMPUTE_SHADER_INVOCATIONS_ARB};
+
+/// The counters of each stage, as a range of Counter
+struct StageCounters {
+  std::size_t first;
+  std::size_t last;
+};
+
+[[nodiscard]] constexpr StageCounters
+stage_counters(PipelineStatistics::Stage stage) noexcept
+{
+  return stage == PipelineStatistics::draw
+             ? StageCounters{PipelineStatistics::vertex_shader_invocations,
+                             PipelineStatistics::compute_shader_invocations}
+             : StageCounters{PipelineStatistics::compute_shader_invocations,
+                             PipelineStatistics::counter_count};
+}
+
+} // anonymous namespace
+
+PipelineStatistics::PipelineStatistics(std::size_t frames_in_flight)
+    : ring_(frames_in_flight)
+{
+  for (auto& slot : ring_) {
+    glGenQueries(counter_count, slot.queries.data());
+  }
+}
+
+PipelineStatistics::~PipelineStatistics()
+{
+  for (auto& slot : ring_) {
+    glDeleteQueries(counter_count, slot.queries.data());
+  }
+}
+
+void PipelineStatistics::begin_frame(std::size_t slot_index,
+                                     std::uint64_t frame)
+{
+  current_ = slot_index;
+  Slot& slot = ring_[current_];
+  resolve(slot, false);
+  slot.frame = frame;
+  slot.recorded = {};
+  slot.last_query = 0;
+}
+
+void PipelineStatistics::begin(Stage stage)
+{
+  const Slot& slot = ring_[current_];
+  const auto [first, last] = stage_counters(stage);
+  for (std::size_t counter = first; counter < last; ++counter) {
+    glBeginQuery(counter_targets[counter], slot.queries[counter]);
+  }
+}
+
+void PipelineStatistics::end(Stage stage)
+{
+  Slot& slot = ring_[current_];
+  const auto [first, last] = stage_counters(stage);
+  for (std::size_t counter = first; counter < last; ++counter) {
+    glEndQuery(counter_targets[counter]);
+  }
+  slot.recorded[stage] = true;
+  slot.last_query = slot.queries[last - 1];
+  slot.pending = true;
+}
+
+void PipelineStatistics::flush()
+{
+  // Oldest first, so that the frames are resolved in order
+  for (std::size_t i = 1; i <= ring_.size(); ++i) {
+    resolve(ring_[(current_ + i) % ring_.size()], true);
+  }
+}
+
+std::vector<PipelineStatistics::FrameCounts>
+PipelineStatistics::take_resolved()
+{
+  std::vector<FrameCounts> resolved(resolved_.begin(), resolved_.end());
+  resolved_.clear();
+  return resolved;
+}
+
+void PipelineStatistics::resolve(Slot& slot, bool wait)
+{
+  if (!slot.pending) {
+    return;
+  }
+  slot.pending = false;
+
+  if (!wait) {
+    GLint available = 0;
+    glGetQueryObjectiv(slot.last_query, GL_QUERY_RESULT_AVAILABLE,
+                       &available);
+    if (available == 0) {
+      ++dropped_frames_;
+      return;
+    }
+  }
+
+  FrameCounts counts{slot.frame, {}};
+  for (const Stage stage : {draw, compute}) {
+    if (!slot.recorded[stage]) {
+      continue;
+    }
+    const auto [first, last] = stage_counters(stage);
+    for (std::size_t counter = first; counter < last; ++counter) {
+      GLuint64 count = 0;
+      glGetQueryObjectui64v(slot.queries[counter], GL_QUERY_RESULT, &count);
+      counts.counts[counter] = count;
+    }
+  }
+
+  latest_ = counts;
+  resolved_.push_back(counts);
+  if (resolved_.size() > max_resolved) {
+    resolved_.pop_front();
+  }
+}
@@ -0,0 +1,103 @@
+#ifndef GLGRASSRENDERER_PIPELINE_STATISTICS_HPP
+#define GLGRASSRENDERER_PIPELINE_STATISTICS_HPP
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * @brief Counts shader invocations and primitives with
+ * GL_ARB_pipeline_statistics_query
+ *
+ * The graphics counters cover the draw stage, the compute counter the
+ * compute stage, so that each can wrap the work it is about. Like GpuTimer,
+ * each frame writes into the queries of its FramePacer slot and reads them
+ * back when the ring comes around, dropping the frame if they are still not
+ * available then.
+ */
+class PipelineStatistics {
+public:
+  enum Stage { draw, compute };
+
+  enum Counter : std::size_t {
+    vertex_shader_invocations,
+    tess_control_patches,
+    tess_evaluation_invocations,
+    clipping_input_primitives,
+    clipping_output_primitives,
+    fragment_shader_invocations,
+    compute_shader_invocations,
+    counter_count
+  };
+  static constexpr const char* counter_names[counter_count] = {
+      "vertex_shader_invocations",   "tess_control_patches",
+      "tess_evaluation_invocations", "clipping_input_primitives",
+      "clipping_output_primitives",  "fragment_shader_invocations",
+      "compute_shader_invocations"};
+
+  struct FrameCounts {
+    std::uint64_t frame = 0;
+    /// 0 for the counters of a stage the frame did not record
+    std::array<std::uint64_t, counter_count> counts{};
+  };
+
+  /// Needs gl_extensions().pipeline_statistics_query
+  explicit PipelineStatistics(std::size_t frames_in_flight);
+  ~PipelineStatistics();
+
+  PipelineStatistics(const PipelineStatistics&) = delete;
+  PipelineStatistics& operator=(const PipelineStatistics&) = delete;
+  PipelineStatistics(PipelineStatistics&&) = delete;
+  PipelineStatistics& operator=(PipelineStatistics&&) = delete;
+
+  /// Resolves the frame last recorded in `slot` and starts recording
+  /// `frame` into it
+  void begin_frame(std::size_t slot, std::uint64_t frame);
+  /// Every stage may be recorded once per frame
+  void begin(Stage stage);
+  void end(Stage stage);
+
+  /// Waits for every recorded frame and resolves it
+  void flush();
+
+  /// The frames resolved since the last call, oldest first. At most
+  /// `max_resolved` are kept when nobody takes them
+  [[nodiscard]] std::vector<FrameCounts> take_resolved();
+
+  /// The last frame resolved
+  [[nodiscard]] const FrameCounts& latest() const noexcept
+  {
+    return latest_;
+  }
+
+  [[nodiscard]] std::size_t dropped_frames() const noexcept
+  {
+    return dropped_frames_;
+  }
+
+private:
+  static constexpr std::size_t max_resolved = 1024;
+
+  struct Slot {
+    std::uint64_t frame = 0;
+    std::array<GLuint, counter_count> queries{};
+    std::array<bool, 2> recorded{};
+    /// The last query ended, which completes after all the others
+    GLuint last_query = 0;
+    bool pending = false;
+  };
+
+  std::vector<Slot> ring_;
+  std::size_t current_ = 0;
+  std::size_t dropped_frames_ = 0;
+  FrameCounts latest_;
+  std::deque<FrameCounts> resolved_;
+
+  void resolve(Slot& slot, bool wait);
+};
+
+#endif // GLGRASSRENDERER_PIPELINE_STATISTICS_HPP
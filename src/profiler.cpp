@@ -0,0 +1,146 @@
+#include "profiler.hpp"
+
+#include <stdexcept>
+
+// Without GLGRASS_PROFILER no zone is ever recorded, and there is no trace to
+// write
+#ifdef GLGRASS_PROFILER
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Zone {
+  const char* name = nullptr;
+  Profiler::Clock::time_point start;
+  Profiler::Clock::time_point end;
+};
+
+struct ThreadZones {
+  std::uint32_t id = 0;
+  std::string name;
+  // Only contended while a trace is being written
+  std::mutex mutex;
+  std::vector<Zone> ring = std::vector<Zone>(Profiler::zones_per_thread);
+  std::size_t recorded = 0;
+};
+
+struct Threads {
+  std::mutex mutex;
+  // Kept alive after their thread exits, so that its zones still get written
+  std::vector<std::shared_ptr<ThreadZones>> zones;
+};
+
+// Trace timestamps count from the start of the process
+const Profiler::Clock::time_point trace_start = Profiler::Clock::now();
+
+[[nodiscard]] Threads& threads()
+{
+  static Threads threads;
+  return threads;
+}
+
+[[nodiscard]] ThreadZones& thread_zones()
+{
+  thread_local const std::shared_ptr<ThreadZones> zones = [] {
+    auto registered = std::make_shared<ThreadZones>();
+    auto& all = threads();
+    std::lock_guard lock{all.mutex};
+    registered->id = static_cast<std::uint32_t>(all.zones.size()) + 1;
+    all.zones.push_back(registered);
+    return registered;
+  }();
+  return *zones;
+}
+
+[[nodiscard]] double microseconds(Profiler::Clock::duration duration)
+{
+  return std::chrono::duration<double, std::micro>{duration}.count();
+}
+
+} // anonymous namespace
+
+void Profiler::set_thread_name(std::string name)
+{
+  auto& zones = thread_zones();
+  std::lock_guard lock{zones.mutex};
+  zones.name = std::move(name);
+}
+
+void Profiler::record(const char* name, Clock::time_point start,
+                      Clock::time_point end) noexcept
+{
+  auto& zones = thread_zones();
+  std::lock_guard lock{zones.mutex};
+  zones.ring[zones.recorded % zones.ring.size()] = {name, start, end};
+  ++zones.recorded;
+}
+
+void Profiler::write_chrome_trace(const std::string& path)
+{
+  std::ofstream file{path};
+  if (!file) {
+    throw std::runtime_error{
+        fmt::format("Failed to open {} for writing", path)};
+  }
+
+  std::vector<std::shared_ptr<ThreadZones>> all;
+  {
+    std::lock_guard lock{threads().mutex};
+    all = threads().zones;
+  }
+
+  // Zone and thread names are string literals of the renderer, they need no
+  // escaping
+  file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  const char* separator = "\n";
+  for (const auto& zones : all) {
+    std::lock_guard lock{zones->mutex};
+    if (!zones->name.empty()) {
+      file << fmt::format("{}{{\"ph\": \"M\", \"name\": \"thread_name\", "
+                          "\"pid\": 1, \"tid\": {}, "
+                          "\"args\": {{\"name\": \"{}\"}}}}",
+                          separator, zones->id, zones->name);
+      separator = ",\n";
+    }
+
+    const std::size_t size = zones->ring.size();
+    const std::size_t count = std::min(zones->recorded, size);
+    for (std::size_t i = zones->recorded - count; i < zones->recorded; ++i) {
+      const Zone& zone = zones->ring[i % size];
+      file << fmt::format("{}{{\"ph\": \"X\", \"name\": \"{}\", \"pid\": 1, "
+                          "\"tid\": {}, \"ts\": {:.3f}, \"dur\": {:.3f}}}",
+                          separator, zone.name, zones->id,
+                          microseconds(zone.start - trace_start),
+                          microseconds(zone.end - zone.start));
+      separator = ",\n";
+    }
+  }
+  file << "\n]}\n";
+  if (!file) {
+    throw std::runtime_error{fmt::format("Failed to write {}", path)};
+  }
+}
+
+#else
+
+void Profiler::set_thread_name(std::string /*name*/) {}
+
+void Profiler::record(const char* /*name*/, Clock::time_point /*start*/,
+                      Clock::time_point /*end*/) noexcept
+{
+}
+
+void Profiler::write_chrome_trace(const std::string& /*path*/)
+{
+  throw std::runtime_error{"Built without the profiler (GLGRASS_PROFILER)"};
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef GLGRASSRENDERER_PROFILER_HPP
+#define GLGRASSRENDERER_PROFILER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Records scoped CPU zones and exports them as Chrome traces
+ *
+ * PROFILE_ZONE("name") times the enclosing scope. Every thread records into
+ * its own ring of `zones_per_thread` zones, overwriting the oldest ones, and
+ * write_chrome_trace() dumps all the rings in the trace event format that
+ * chrome://tracing and Perfetto open.
+ *
+ * Zones are only recorded when the app is built with GLGRASS_PROFILER.
+ * Otherwise the macros expand to nothing and write_chrome_trace() throws
+ * std::runtime_error.
+ */
+class Profiler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+#ifdef GLGRASS_PROFILER
+  static constexpr bool enabled = true;
+#else
+  static constexpr bool enabled = false;
+#endif
+
+  static constexpr std::size_t zones_per_thread = 1 << 16;
+
+  /// Names the calling thread in the traces
+  static void set_thread_name(std::string name);
+
+  /// `name` must outlive the profiler, a string literal does
+  static void record(const char* name, Clock::time_point start,
+                     Clock::time_point end) noexcept;
+
+  static void write_chrome_trace(const std::string& path);
+};
+
+/// Records its lifetime as a zone, use it through PROFILE_ZONE
+class ProfileZone {
+public:
+  explicit ProfileZone(const char* name) noexcept
+      : name_{name}, start_{Profiler::Clock::now()}
+  {
+  }
+
+  ~ProfileZone()
+  {
+    Profiler::record(name_, start_, Profiler::Clock::now());
+  }
+
+  ProfileZone(const ProfileZone&) = delete;
+  ProfileZone& operator=(const ProfileZone&) = delete;
+  ProfileZone(ProfileZone&&) = delete;
+  ProfileZone& operator=(ProfileZone&&) = delete;
+
+private:
+  const char* name_;
+  Profiler::Clock::time_point start_;
+};
+
+#ifdef GLGRASS_PROFILER
+#define GLGRASS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GLGRASS_PROFILE_CONCAT(a, b) GLGRASS_PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name)                                                     \
+  const ProfileZone GLGRASS_PROFILE_CONCAT(profile_zone_, __LINE__)            \
+  {                                                                            \
+    name                                                                       \
+  }
+#define PROFILE_THREAD(name) Profiler::set_thread_name(name)
+#else
+#define PROFILE_ZONE(name) static_cast<void>(0)
+#define PROFILE_THREAD(name) static_cast<void>(0)
+#endif
+
+#endif // GLGRASSRENDERER_PROFILER_HPP
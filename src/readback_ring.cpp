@@ -0,0 +1,35 @@
+#include "readback_ring.hpp"
+#include "gl_extensions.hpp"
+
+namespace {
+
+constexpr GLbitfield mapping_flags =
+    GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+} // anonymous namespace
+
+// Client storage hints the driver to keep the buffer in memory the CPU reads
+// quickly, the GPU only ever writes it once per frame
+ReadbackRing::ReadbackRing(std::size_t frames_in_flight,
+                           std::size_t frame_size)
+    : frame_size_{frame_size},
+      buffer_{static_cast<GLsizeiptr>(frame_size_ * frames_in_flight), nullptr,
+              mapping_flags | GL_CLIENT_STORAGE_BIT}
+{
+  memory_ = static_cast<const unsigned char*>(
+      glMapNamedBufferRange(buffer_.id(), 0, buffer_.size(), mapping_flags));
+}
+
+ReadbackRing::~ReadbackRing()
+{
+  glUnmapNamedBuffer(buffer_.id());
+}
+
+void ReadbackRing::copy(std::size_t slot, std::size_t offset,
+                        const Buffer& source, GLintptr source_offset,
+                        GLsizeiptr size)
+{
+  glCopyNamedBufferSubData(
+      source.id(), buffer_.id(), source_offset,
+      static_cast<GLintptr>(slot * frame_size_ + offset), size);
+}
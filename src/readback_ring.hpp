@@ -0,0 +1,50 @@
+#ifndef GLGRASSRENDERER_READBACK_RING_HPP
+#define GLGRASSRENDERER_READBACK_RING_HPP
+
+#include "gl_objects.hpp"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @brief Brings small GPU results back to the CPU without stalling
+ *
+ * The buffer is persistently mapped for reading and split into one region per
+ * frame in flight. A frame copies its results into the region of its
+ * FramePacer slot, and reads them when the slot comes around again: the pacer
+ * has then waited on the fence of the frame that copied them.
+ */
+class ReadbackRing {
+public:
+  ReadbackRing(std::size_t frames_in_flight, std::size_t frame_size);
+  ~ReadbackRing();
+
+  ReadbackRing(const ReadbackRing&) = delete;
+  ReadbackRing& operator=(const ReadbackRing&) = delete;
+  ReadbackRing(ReadbackRing&&) = delete;
+  ReadbackRing& operator=(ReadbackRing&&) = delete;
+
+  /// Copies `size` bytes of `source` from `source_offset` to `offset` in the
+  /// region of `slot`
+  void copy(std::size_t slot, std::size_t offset, const Buffer& source,
+            GLintptr source_offset, GLsizeiptr size);
+
+  /// What the last copy() to `offset` in the region of `slot` wrote, once
+  /// the GPU is done with it
+  template <typename T>
+  [[nodiscard]] T read(std::size_t slot, std::size_t offset) const
+  {
+    T value;
+    std::memcpy(&value, memory_ + slot * frame_size_ + offset, sizeof(T));
+    return value;
+  }
+
+private:
+  std::size_t frame_size_ = 0;
+  Buffer buffer_;
+  const unsigned char* memory_ = nullptr;
+};
+
+#endif // GLGRASSRENDERER_READBACK_RING_HPP
@@ -0,0 +1,232 @@
+#include "render_graph.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+using Access = RenderGraph::Access;
+
+/// The glMemoryBarrier() bit that orders shader storage and image writes
+/// before `access`
+[[nodiscard]] constexpr GLbitfield barrier_bit(Access access) noexcept
+{
+  switch (access) {
+  case Access::shader_storage:
+    return GL_SHADER_STORAGE_BARRIER_BIT;
+  case Access::shader_image:
+    return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+  case Access::indirect_command:
+    return GL_COMMAND_BARRIER_BIT;
+  case Access::vertex_attribute:
+    return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+  case Access::uniform:
+    return GL_UNIFORM_BARRIER_BIT;
+  case Access::texture_fetch:
+    return GL_TEXTURE_FETCH_BARRIER_BIT;
+  case Access::buffer_update:
+    return GL_BUFFER_UPDATE_BARRIER_BIT;
+  case Access::framebuffer:
+    return GL_FRAMEBUFFER_BARRIER_BIT;
+  }
+  return GL_ALL_BARRIER_BITS;
+}
+
+[[nodiscard]] constexpr bool can_write(Access access) noexcept
+{
+  return access == Access::shader_storage || access == Access::shader_image ||
+         access == Access::buffer_update || access == Access::framebuffer;
+}
+
+[[nodiscard]] constexpr bool is_incoherent(Access access) noexcept
+{
+  return access == Access::shader_storage || access == Access::shader_image;
+}
+
+} // anonymous namespace
+
+RenderGraph::Pass::Pass(std::string name, Queue queue,
+                        std::function<void()> execute)
+    : name_{std::move(name)}, queue_{queue}, execute_{std::move(execute)}
+{
+}
+
+RenderGraph::Pass& RenderGraph::Pass::read(Resource resource, Access access)
+{
+  uses_.push_back({resource, access, false});
+  return *this;
+}
+
+RenderGraph::Pass& RenderGraph::Pass::write(Resource resource, Access access)
+{
+  if (!can_write(access)) {
+    throw std::runtime_error{
+        fmt::format("Pass {} writes a resource through an access that only "
+                    "reads",
+                    name_)};
+  }
+  uses_.push_back({resource, access, true});
+  return *this;
+}
+
+RenderGraph::Resource RenderGraph::resource(std::string name)
+{
+  resources_.push_back(std::move(name));
+  outputs_.push_back(false);
+  return resources_.size() - 1;
+}
+
+void RenderGraph::output(Resource resource)
+{
+  outputs_[resource] = true;
+}
+
+RenderGraph::Pass& RenderGraph::add_pass(std::string name, Queue queue,
+                                         std::function<void()> execute)
+{
+  return passes_.emplace_back(Pass{std::move(name), queue, std::move(execute)});
+}
+
+void RenderGraph::compile()
+{
+  const std::vector<bool> live = live_passes();
+  schedule_.clear();
+  for (const std::size_t pass : order(live)) {
+    schedule_.push_back({pass, 0});
+  }
+  place_barriers();
+}
+
+void RenderGraph::execute() const
+{
+  for (const Step& step : schedule_) {
+    if (step.barriers != 0) {
+      glMemoryBarrier(step.barriers);
+    }
+    passes_[step.pass].execute_();
+  }
+}
+
+// Walks back from the outputs: a pass lives when it writes a resource that is
+// an output or is read by a later live pass
+std::vector<bool> RenderGraph::live_passes() const
+{
+  std::vector<bool> needed = outputs_;
+  std::vector<bool> live(passes_.size(), false);
+  for (std::size_t pass = passes_.size(); pass-- > 0;) {
+    const auto& uses = passes_[pass].uses_;
+    live[pass] = std::ranges::any_of(uses, [&](const Pass::Use& use) {
+      return use.write && needed[use.resource];
+    });
+    if (!live[pass]) {
+      continue;
+    }
+    for (const Pass::Use& use : uses) {
+      if (!use.write) {
+        needed[use.resource] = true;
+      }
+    }
+  }
+  return live;
+}
+
+// A pass must stay after every earlier pass it shares a resource with, unless
+// both only read it. Among the passes that may run next, compute passes go
+// first, then the order of add_pass()
+std::vector<std::size_t>
+RenderGraph::order(const std::vector<bool>& live) const
+{
+  const auto conflict = [this](std::size_t earlier, std::size_t later) {
+    for (const Pass::Use& a : passes_[earlier].uses_) {
+      for (const Pass::Use& b : passes_[later].uses_) {
+        if (a.resource == b.resource && (a.write || b.write)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+
+  std::vector<bool> scheduled(passes_.size(), false);
+  const auto ready = [&](std::size_t pass) {
+    for (std::size_t earlier = 0; earlier < pass; ++earlier) {
+      if (live[earlier] && !scheduled[earlier] && conflict(earlier, pass)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  std::vector<std::size_t> sequence;
+  const auto live_count =
+      static_cast<std::size_t>(std::ranges::count(live, true));
+  while (sequence.size() < live_count) {
+    std::size_t next = passes_.size();
+    for (std::size_t pass = 0; pass < passes_.size(); ++pass) {
+      if (!live[pass] || scheduled[pass] || !ready(pass)) {
+        continue;
+      }
+      if (next == passes_.size()) {
+        next = pass;
+      }
+      if (passes_[pass].queue_ == Queue::compute) {
+        next = pass;
+        break;
+      }
+    }
+    scheduled[next] = true;
+    sequence.push_back(next);
+  }
+  return sequence;
+}
+
+// Tracks per resource the barrier bits not issued since its last shader
+// storage or image write. The schedule is walked twice, and the second walk,
+// which starts from the writes of the first, gives the barriers of every
+// frame
+void RenderGraph::place_barriers()
+{
+  std::vector<GLbitfield> unsynced(resources_.size(), 0);
+  for (int frame = 0; frame < 2; ++frame) {
+    for (Step& step : schedule_) {
+      const auto& uses = passes_[step.pass].uses_;
+      step.barriers = 0;
+      for (const Pass::Use& use : uses) {
+        step.barriers |= unsynced[use.resource] & barrier_bit(use.access);
+      }
+      // A barrier orders every earlier write, whatever resource it went to
+      for (GLbitfield& bits : unsynced) {
+        bits &= ~step.barriers;
+      }
+      for (const Pass::Use& use : uses) {
+        if (use.write && is_incoherent(use.access)) {
+          unsynced[use.resource] = GL_ALL_BARRIER_BITS;
+        }
+      }
+    }
+  }
+}
+
+std::string barrier_names(GLbitfield barriers)
+{
+  constexpr std::pair<GLbitfield, const char*> names[] = {
+      {GL_SHADER_STORAGE_BARRIER_BIT, "shader storage"},
+      {GL_SHADER_IMAGE_ACCESS_BARRIER_BIT, "shader image"},
+      {GL_COMMAND_BARRIER_BIT, "command"},
+      {GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT, "vertex attribute"},
+      {GL_UNIFORM_BARRIER_BIT, "uniform"},
+      {GL_TEXTURE_FETCH_BARRIER_BIT, "texture fetch"},
+      {GL_BUFFER_UPDATE_BARRIER_BIT, "buffer update"},
+      {GL_FRAMEBUFFER_BARRIER_BIT, "framebuffer"},
+  };
+  std::string result;
+  for (const auto& [bit, name] : names) {
+    if ((barriers & bit) != 0) {
+      result += result.empty() ? name : fmt::format(" | {}", name);
+    }
+  }
+  return result;
+}
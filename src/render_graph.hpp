@@ -0,0 +1,127 @@
+#ifndef GLGRASSRENDERER_RENDER_GRAPH_HPP
+#define GLGRASSRENDERER_RENDER_GRAPH_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Schedules the passes of a frame from the resources they declare
+ *
+ * Passes are added in the order their effects must appear in, each with the
+ * resources it reads and writes. compile() then:
+ * - culls the passes that contribute nothing to an output resource,
+ * - orders the remaining ones, running compute passes as early as their
+ *   inputs allow so that raster work overlaps them,
+ * - places before each pass the glMemoryBarrier() bits that make the shader
+ *   storage and image writes of earlier passes visible to the way it
+ *   accesses them.
+ *
+ * Barriers are computed for the steady state in which each frame follows the
+ * previous one, so writes that the next frame reads or overwrites are covered
+ * too.
+ */
+class RenderGraph {
+public:
+  using Resource = std::size_t;
+
+  /// How a pass accesses a resource. Each access has its own barrier bit
+  enum class Access {
+    /// Shader storage blocks. Its writes are incoherent
+    shader_storage,
+    /// Image load, store and atomics. Its writes are incoherent
+    shader_image,
+    /// Indirect draw or dispatch arguments
+    indirect_command,
+    vertex_attribute,
+    uniform,
+    texture_fetch,
+    /// glBufferSubData() and the like, written in submission order
+    buffer_update,
+    /// Rendering into a framebuffer, written in submission order
+    framebuffer,
+  };
+
+  enum class Queue {
+    graphics,
+    compute,
+  };
+
+  class Pass {
+  public:
+    Pass& read(Resource resource, Access access);
+    /// Throws std::runtime_error for an access that cannot write, such as
+    /// an indirect command
+    Pass& write(Resource resource, Access access);
+
+  private:
+    friend class RenderGraph;
+
+    struct Use {
+      Resource resource;
+      Access access;
+      bool write;
+    };
+
+    Pass(std::string name, Queue queue, std::function<void()> execute);
+
+    std::string name_;
+    Queue queue_;
+    std::function<void()> execute_;
+    std::vector<Use> uses_;
+  };
+
+  struct Step {
+    std::size_t pass = 0;
+    /// Issued with glMemoryBarrier() before the pass, 0 for none
+    GLbitfield barriers = 0;
+  };
+
+  [[nodiscard]] Resource resource(std::string name);
+  /// Keeps the passes writing `resource` and the passes they depend on
+  void output(Resource resource);
+
+  /// The returned pass stays valid until the next add_pass()
+  Pass& add_pass(std::string name, Queue queue,
+                 std::function<void()> execute);
+
+  void compile();
+  /// Runs the schedule of the last compile()
+  void execute() const;
+
+  [[nodiscard]] const std::vector<Step>& schedule() const noexcept
+  {
+    return schedule_;
+  }
+
+  [[nodiscard]] std::string_view pass_name(std::size_t pass) const
+  {
+    return passes_[pass].name_;
+  }
+
+  [[nodiscard]] std::size_t pass_count() const noexcept
+  {
+    return passes_.size();
+  }
+
+private:
+  std::vector<std::string> resources_;
+  std::vector<bool> outputs_;
+  std::vector<Pass> passes_;
+  std::vector<Step> schedule_;
+
+  [[nodiscard]] std::vector<bool> live_passes() const;
+  [[nodiscard]] std::vector<std::size_t>
+  order(const std::vector<bool>& live) const;
+  void place_barriers();
+};
+
+/// The names of the glMemoryBarrier() bits in `barriers`, such as "command |
+/// vertex attribute"
+[[nodiscard]] std::string barrier_names(GLbitfield barriers);
+
+#endif // GLGRASSRENDERER_RENDER_GRAPH_HPP
@@ -0,0 +1,174 @@
+#include "resource_manager.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+
+ResourceManager::ResourceManager(ShaderWatcher& shader_watcher)
+{
+  programs_.set_watcher(&shader_watcher);
+}
+
+TextureHandle ResourceManager::find_texture(std::string_view key)
+{
+  const auto it =
+      std::find_if(textures_.begin(), textures_.end(),
+                   [&](const auto& entry) { return entry.key == key; });
+  if (it == textures_.end()) {
+    return {};
+  }
+  return TextureHandle{it->resource.lock()};
+}
+
+TextureHandle ResourceManager::load_texture(std::string_view subsystem,
+                                            std::string_view path)
+{
+  if (auto texture = find_texture(path); texture.request_ != nullptr) {
+    return texture;
+  }
+
+  collect_garbage();
+  auto texture = texture_loader_.load_texture(path);
+  textures_.push_back(
+      {std::string{subsystem}, std::string{path}, texture.request_});
+  return texture;
+}
+
+TextureHandle ResourceManager::load_cubemap(std::string_view subsystem,
+                                            std::vector<std::string> faces)
+{
+  std::string key;
+  for (const auto& face : faces) {
+    key += face;
+    key += '\n';
+  }
+  if (auto texture = find_texture(key); texture.request_ != nullptr) {
+    return texture;
+  }
+
+  collect_garbage();
+  auto texture = texture_loader_.load_cubemap(std::move(faces));
+  textures_.push_back(
+      {std::string{subsystem}, std::move(key), texture.request_});
+  return texture;
+}
+
+TextureHandle ResourceManager::create_texture(
+    std::string_view subsystem, std::string_view key, GLsizei width,
+    GLsizei height, GLenum internal_format, GLenum format, GLenum type,
+    const void* pixels, std::size_t memory_size)
+{
+  if (auto texture = find_texture(key); texture.request_ != nullptr) {
+    return texture;
+  }
+
+  collect_garbage();
+  auto texture =
+      texture_loader_.create_texture(width, height, internal_format, format,
+                                     type, pixels, memory_size);
+  textures_.push_back(
+      {std::string{subsystem}, std::string{key}, texture.request_});
+  return texture;
+}
+
+TextureHandle ResourceManager::create_texture_array(
+    std::string_view subsystem, std::string_view key, GLsizei width,
+    GLsizei height, GLsizei layers, GLenum internal_format,
+    std::size_t memory_size)
+{
+  if (auto texture = find_texture(key); texture.request_ != nullptr) {
+    return texture;
+  }
+
+  collect_garbage();
+  auto texture = texture_loader_.create_texture_array(
+      width, height, layers, internal_format, memory_size);
+  textures_.push_back(
+      {std::string{subsystem}, std::string{key}, texture.request_});
+  return texture;
+}
+
+std::shared_ptr<Buffer>
+ResourceManager::buffer(std::string_view subsystem, std::string_view key,
+                        GLsizeiptr size, const void* data, GLbitfield flags)
+{
+  if (!key.empty()) {
+    const auto it =
+        std::find_if(buffers_.begin(), buffers_.end(),
+                     [&](const auto& entry) { return entry.key == key; });
+    if (it != buffers_.end()) {
+      if (auto buffer = it->resource.lock()) {
+        return buffer;
+      }
+    }
+  }
+
+  collect_garbage();
+  auto buffer = std::make_shared<Buffer>(size, data, flags);
+  buffers_.push_back({std::string{subsystem}, std::string{key}, buffer});
+  return buffer;
+}
+
+ShaderProgram& ResourceManager::program(const ShaderBuilder& builder)
+{
+  return programs_.get(builder);
+}
+
+bool ResourceManager::programs_ready() const
+{
+  return programs_.ready();
+}
+
+void ResourceManager::finalize_programs()
+{
+  programs_.finalize();
+}
+
+void ResourceManager::update()
+{
+  PROFILE_ZONE("update_resources");
+  texture_loader_.update();
+}
+
+bool ResourceManager::textures_idle() const
+{
+  return texture_loader_.idle();
+}
+
+std::vector<MemoryUsage> ResourceManager::memory_usage()
+{
+  collect_garbage();
+
+  std::vector<MemoryUsage> usage;
+  const auto usage_of = [&](const std::string& subsystem) -> MemoryUsage& {
+    const auto it =
+        std::find_if(usage.begin(), usage.end(), [&](const auto& entry) {
+          return entry.subsystem == subsystem;
+        });
+    return it != usage.end() ? *it : usage.emplace_back(MemoryUsage{subsystem});
+  };
+
+  for (const auto& entry : textures_) {
+    if (const auto texture = entry.resource.lock()) {
+      auto& subsystem = usage_of(entry.subsystem);
+      ++subsystem.texture_count;
+      subsystem.texture_bytes += TextureHandle{texture}.memory_size();
+    }
+  }
+  for (const auto& entry : buffers_) {
+    if (const auto buffer = entry.resource.lock()) {
+      auto& subsystem = usage_of(entry.subsystem);
+      ++subsystem.buffer_count;
+      subsystem.buffer_bytes += static_cast<std::size_t>(buffer->size());
+    }
+  }
+  return usage;
+}
+
+void ResourceManager::collect_garbage()
+{
+  const auto expired = [](const auto& entry) {
+    return entry.resource.expired();
+  };
+  std::erase_if(textures_, expired);
+  std::erase_if(buffers_, expired);
+}
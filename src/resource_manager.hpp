@@ -0,0 +1,104 @@
+#ifndef GLGRASSRENDERER_RESOURCE_MANAGER_HPP
+#define GLGRASSRENDERER_RESOURCE_MANAGER_HPP
+
+#include "gl_objects.hpp"
+#include "shader.hpp"
+#include "texture.hpp"
+
+#include <glad/glad.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// The GPU memory held by one subsystem
+struct MemoryUsage {
+  std::string subsystem;
+  std::size_t texture_count = 0;
+  std::size_t texture_bytes = 0;
+  std::size_t buffer_count = 0;
+  std::size_t buffer_bytes = 0;
+};
+
+/**
+ * @brief Owns the cache of every texture, buffer and shader program
+ *
+ * Textures and keyed buffers are deduplicated: asking for the same key again
+ * returns the resource that is already alive. Textures and buffers are
+ * reference counted and freed with their last handle; the cache only keeps
+ * weak references to them. Programs live as long as the manager, because the
+ * shader watcher refers to them.
+ *
+ * Each resource is accounted to the subsystem that created it, which lets the
+ * GUI show how much VRAM every part of the renderer holds.
+ */
+class ResourceManager {
+public:
+  explicit ResourceManager(ShaderWatcher& shader_watcher);
+
+  ResourceManager(const ResourceManager&) = delete;
+  ResourceManager& operator=(const ResourceManager&) = delete;
+  ResourceManager(ResourceManager&&) = delete;
+  ResourceManager& operator=(ResourceManager&&) = delete;
+
+  [[nodiscard]] TextureHandle load_texture(std::string_view subsystem,
+                                           std::string_view path);
+  [[nodiscard]] TextureHandle load_cubemap(std::string_view subsystem,
+                                           std::vector<std::string> faces);
+
+  /// Returns the texture cached under `key`, or creates it from `pixels`.
+  /// See TextureLoader::create_texture()
+  [[nodiscard]] TextureHandle
+  create_texture(std::string_view subsystem, std::string_view key,
+                 GLsizei width, GLsizei height, GLenum internal_format,
+                 GLenum format, GLenum type, const void* pixels,
+                 std::size_t memory_size);
+
+  /// Returns the array texture cached under `key`, or allocates it. See
+  /// TextureLoader::create_texture_array()
+  [[nodiscard]] TextureHandle
+  create_texture_array(std::string_view subsystem, std::string_view key,
+                       GLsizei width, GLsizei height, GLsizei layers,
+                       GLenum internal_format, std::size_t memory_size);
+
+  /// Returns the buffer cached under `key`, or creates it from `data` with
+  /// the storage `flags`. An empty key always creates a new buffer. The
+  /// buffer is deleted with its last reference
+  [[nodiscard]] std::shared_ptr<Buffer>
+  buffer(std::string_view subsystem, std::string_view key, GLsizeiptr size,
+         const void* data, GLbitfield flags);
+
+  /// Returns the program built from `builder`, submitting it on first use.
+  /// The returned program may still need ShaderProgram::finalize()
+  [[nodiscard]] ShaderProgram& program(const ShaderBuilder& builder);
+
+  [[nodiscard]] bool programs_ready() const;
+  void finalize_programs();
+
+  /// Uploads the textures that finished loading. Call once per frame
+  void update();
+
+  /// Whether every requested texture has been uploaded
+  [[nodiscard]] bool textures_idle() const;
+
+  /// The memory held by live resources, per subsystem
+  [[nodiscard]] std::vector<MemoryUsage> memory_usage();
+
+private:
+  template <typename Resource> struct Entry {
+    std::string subsystem;
+    std::string key;
+    std::weak_ptr<Resource> resource;
+  };
+
+  TextureLoader texture_loader_;
+  ShaderCache programs_;
+  std::vector<Entry<TextureRequest>> textures_;
+  std::vector<Entry<Buffer>> buffers_;
+
+  [[nodiscard]] TextureHandle find_texture(std::string_view key);
+  void collect_garbage();
+};
+
+#endif // GLGRASSRENDERER_RESOURCE_MANAGER_HPP
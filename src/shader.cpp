@@ -1,10 +1,21 @@
+#include <algorithm>
 #include <type_traits>
 
 #include "shader.hpp"
 
+#include "asset_pack.hpp"
+#include "embedded_shaders.hpp"
+#include "gl_extensions.hpp"
+#include "profiler.hpp"
+#include "shader_preprocessor.hpp"
+#include "shader_watcher.hpp"
+
+#include <mutex>
+#include <unordered_set>
+
 namespace {
 
-void checkCompilingError(unsigned int shader_id)
+void checkCompilingError(unsigned int shader_id, const std::string& name)
 {
   int success;
   glGetShaderiv(shader_id, GL_COMPILE_STATUS, &success);
@@ -14,8 +25,9 @@ void checkCompilingError(unsigned int shader_id)
     char info_log[max_log_size];
     glGetShaderInfoLog(shader_id, max_log_size, nullptr,
                        static_cast<char*>(info_log));
-    throw std::runtime_error{fmt::format(
-        "Shader compilation error for shader {}: {}", shader_id, info_log)};
+    throw std::runtime_error{
+        fmt::format("Shader compilation error for shader {}: {}", name,
+                    static_cast<const char*>(info_log))};
   }
 }
 
@@ -31,14 +43,45 @@ void checkLinkingError(unsigned int program_id)
   }
 }
 
+// Files that changed on disk since startup and must no longer come from the
+// embedded copies. Locked because the watcher preprocesses in the background
+std::mutex modified_sources_mutex;
+std::unordered_set<std::string> modified_sources;
+
+[[nodiscard]] bool is_modified(const std::string& filename)
+{
+  const std::scoped_lock lock{modified_sources_mutex};
+  return modified_sources.contains(filename);
+}
+
+[[nodiscard]] std::string load_shader_source(const std::string& filename)
+{
+  if (is_modified(filename)) {
+    return readFile(filename);
+  }
+  if (const auto embedded = find_embedded_shader(filename)) {
+    return std::string{*embedded};
+  }
+  if (const auto asset = load_asset(filename)) {
+    return std::string{asset->text()};
+  }
+  throw std::runtime_error{fmt::format("Cannot open shader {}", filename)};
+}
+
 } // anonymous namespace
 
-Shader::Shader(const char* source, Shader::Type type)
-    : type_{type}, id_{glCreateShader(std::underlying_type_t<Type>(type))}
+void mark_shader_source_modified(const std::string& filename)
+{
+  const std::scoped_lock lock{modified_sources_mutex};
+  modified_sources.insert(filename);
+}
+
+Shader::Shader(const char* source, Shader::Type type, std::string name)
+    : type_{type}, id_{glCreateShader(std::underlying_type_t<Type>(type))},
+      name_{std::move(name)}
 {
   glShaderSource(id_, 1, &source, nullptr);
   glCompileShader(id_);
-  checkCompilingError(id_);
 }
 
 Shader::~Shader()
@@ -46,7 +89,8 @@ Shader::~Shader()
   glDeleteShader(id_);
 }
 
-Shader::Shader(Shader&& other) noexcept : type_{other.type_}, id_{other.id_}
+Shader::Shader(Shader&& other) noexcept
+    : type_{other.type_}, id_{other.id_}, name_{std::move(other.name_)}
 {
   other.id_ = 0;
 }
@@ -55,16 +99,169 @@ Shader& Shader::operator=(Shader&& other) noexcept
 {
   std::swap(id_, other.id_);
   std::swap(type_, other.type_);
+  std::swap(name_, other.name_);
   return *this;
 }
 
-ShaderProgram::ShaderProgram(const std::vector<Shader>& shaders)
-    : id_{glCreateProgram()}
+void Shader::check_compile_status() const
+{
+  checkCompilingError(id_, name_);
+}
+
+ShaderProgram::ShaderProgram(std::vector<Shader> shaders,
+                             std::vector<std::string> source_files,
+                             std::vector<const BufferBlockLayout*> layouts)
+    : id_{glCreateProgram()}, pending_shaders_{std::move(shaders)},
+      source_files_{std::move(source_files)}, layouts_{std::move(layouts)}
 {
-  for (const auto& shader : shaders) {
+  for (const auto& shader : pending_shaders_) {
     glAttachShader(id_, shader.id_);
   }
 
   glLinkProgram(id_);
+}
+
+ShaderProgram::~ShaderProgram()
+{
+  gl_state().forget_program(id_);
+  glDeleteProgram(id_);
+}
+
+ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept
+    : id_{other.id_}, pending_shaders_{std::move(other.pending_shaders_)},
+      source_files_{std::move(other.source_files_)},
+      layouts_{std::move(other.layouts_)}
+{
+  other.id_ = 0;
+}
+
+ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) noexcept
+{
+  std::swap(id_, other.id_);
+  std::swap(pending_shaders_, other.pending_shaders_);
+  std::swap(source_files_, other.source_files_);
+  std::swap(layouts_, other.layouts_);
+  return *this;
+}
+
+bool ShaderProgram::ready() const
+{
+  if (pending_shaders_.empty() || !gl_extensions().parallel_shader_compile) {
+    return true;
+  }
+
+  int completed = GL_FALSE;
+  glGetProgramiv(id_, GL_COMPLETION_STATUS_KHR, &completed);
+  return completed == GL_TRUE;
+}
+
+void ShaderProgram::finalize()
+{
+  if (pending_shaders_.empty()) {
+    return;
+  }
+  PROFILE_ZONE("finalize_program");
+
+  // A failed compile also fails the link, so report the more specific error
+  // first
+  for (const auto& shader : pending_shaders_) {
+    shader.check_compile_status();
+  }
   checkLinkingError(id_);
+
+  std::string mismatches;
+  for (const auto* layout : layouts_) {
+    for (const auto& mismatch : find_layout_mismatches(id_, *layout)) {
+      mismatches += fmt::format("\n  {}", mismatch);
+    }
+  }
+  if (!mismatches.empty()) {
+    throw std::runtime_error{fmt::format(
+        "Buffer layout mismatch in {}:{}",
+        source_files_.empty() ? "shader program" : source_files_.front(),
+        mismatches)};
+  }
+
+  for (const auto& shader : pending_shaders_) {
+    glDetachShader(id_, shader.id_);
+  }
+  pending_shaders_.clear();
+}
+
+std::string ShaderBuilder::key() const
+{
+  std::string key;
+  for (const auto& stage : stages_) {
+    key += fmt::format("{}:{};",
+                       std::underlying_type_t<Shader::Type>(stage.type),
+                       stage.filename);
+  }
+  for (const auto& [name, value] : defines_) {
+    key += fmt::format("{}={};", name, value);
+  }
+  return key;
+}
+
+ShaderProgram ShaderBuilder::build() const
+{
+  PROFILE_ZONE("build_program");
+  return submit(preprocess());
+}
+
+PreprocessedProgram ShaderBuilder::preprocess() const
+{
+  PROFILE_ZONE("preprocess_program");
+  PreprocessedProgram program;
+  program.stages.reserve(stages_.size());
+  for (const auto& stage : stages_) {
+    auto preprocessed =
+        preprocess_shader(stage.filename, defines_, load_shader_source);
+    auto name = preprocessed.describe();
+    program.stages.push_back(
+        {std::move(preprocessed.source), stage.type, std::move(name)});
+    for (const auto& file : preprocessed.files) {
+      if (std::find(program.source_files.begin(), program.source_files.end(),
+                    file) == program.source_files.end()) {
+        program.source_files.push_back(file);
+      }
+    }
+  }
+  return program;
+}
+
+ShaderProgram ShaderBuilder::submit(const PreprocessedProgram& program) const
+{
+  std::vector<Shader> shaders;
+  shaders.reserve(program.stages.size());
+  for (const auto& stage : program.stages) {
+    shaders.emplace_back(stage.source.c_str(), stage.type, stage.name);
+  }
+  return ShaderProgram{std::move(shaders), program.source_files, layouts_};
+}
+
+ShaderProgram& ShaderCache::get(const ShaderBuilder& builder)
+{
+  auto key = builder.key();
+  if (const auto it = programs_.find(key); it != programs_.end()) {
+    return it->second;
+  }
+  auto& program =
+      programs_.emplace(std::move(key), builder.build()).first->second;
+  if (watcher_ != nullptr) {
+    watcher_->watch(program, builder);
+  }
+  return program;
+}
+
+bool ShaderCache::ready() const
+{
+  return std::all_of(programs_.begin(), programs_.end(),
+                     [](const auto& entry) { return entry.second.ready(); });
+}
+
+void ShaderCache::finalize()
+{
+  for (auto& [key, program] : programs_) {
+    program.finalize();
+  }
 }
@@ -4,15 +4,21 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "buffer_layout.hpp"
+#include "gl_state.hpp"
+
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <fmt/format.h>
 
 class ShaderProgram;
+class ShaderWatcher;
 
 /**
  * @ingroup opengl
@@ -30,7 +36,9 @@ public:
     Compute = GL_COMPUTE_SHADER
   };
 
-  Shader(const char* source, Type type);
+  /// Submits the shader for compilation. The compile status is not checked
+  /// until ShaderProgram::finalize() so that drivers can compile in parallel
+  Shader(const char* source, Type type, std::string name = {});
   ~Shader();
 
   Shader(const Shader& other) = delete;
@@ -41,6 +49,9 @@ public:
 private:
   Type type_;
   unsigned int id_;
+  std::string name_;
+
+  void check_compile_status() const;
 
   friend ShaderProgram;
 };
@@ -62,14 +73,38 @@ private:
   return ss.str();
 }
 
+/// Makes subsequent builds read `filename` from disk rather than from the
+/// sources embedded at build time
+void mark_shader_source_modified(const std::string& filename);
+
 class ShaderProgram {
 public:
   ShaderProgram() = default;
-  explicit ShaderProgram(const std::vector<Shader>& shaders);
+  /// Attaches the shaders and submits the link without waiting for it.
+  /// `source_files` lists every file the sources were built from, and
+  /// `layouts` the buffer blocks that finalize() verifies
+  explicit ShaderProgram(
+      std::vector<Shader> shaders, std::vector<std::string> source_files = {},
+      std::vector<const BufferBlockLayout*> layouts = {});
+  ~ShaderProgram();
+
+  ShaderProgram(const ShaderProgram& other) = delete;
+  ShaderProgram& operator=(const ShaderProgram& other) = delete;
+  ShaderProgram(ShaderProgram&& other) noexcept;
+  ShaderProgram& operator=(ShaderProgram&& other) noexcept;
+
+  /// Whether compiling and linking has completed. Never blocks when
+  /// GL_KHR_parallel_shader_compile is available
+  [[nodiscard]] bool ready() const;
+
+  /// Waits for compiling and linking and throws on error, or if a buffer block
+  /// does not match its expected layout. Must be called before the program is
+  /// used
+  void finalize();
 
   void use() const
   {
-    glUseProgram(id_);
+    gl_state().use_program(id_);
   }
 
   [[nodiscard]] unsigned int id() const
@@ -77,6 +112,11 @@ public:
     return id_;
   }
 
+  [[nodiscard]] const std::vector<std::string>& source_files() const
+  {
+    return source_files_;
+  }
+
   void setBool(const std::string& name, bool value) const
   {
     glUniform1i(glGetUniformLocation(id_, name.c_str()),
@@ -132,27 +172,110 @@ public:
   }
 
 private:
-  unsigned int id_;
+  unsigned int id_ = 0;
+  std::vector<Shader> pending_shaders_;
+  std::vector<std::string> source_files_;
+  std::vector<const BufferBlockLayout*> layouts_;
 };
 
+/// The sources of a program after preprocessing, which needs no GL context
+struct PreprocessedProgram {
+  struct Stage {
+    std::string source;
+    Shader::Type type;
+    std::string name;
+  };
+
+  std::vector<Stage> stages;
+  /// Every file the sources were built from
+  std::vector<std::string> source_files;
+};
+
+/**
+ * @brief Describes a shader program and builds it
+ *
+ * Sources are run through a small preprocessor before compiling: `#include
+ * "file"` directives are expanded relative to the including file, and every
+ * define() is injected right after the `#version` line.
+ */
 class ShaderBuilder {
 public:
   ShaderBuilder() = default;
 
   ShaderBuilder& load(std::string_view filename, Shader::Type type)
   {
-    const std::string src = readFile(filename);
-    shaders_.emplace_back(src.c_str(), type);
+    stages_.push_back({std::string{filename}, type});
     return *this;
   }
 
-  [[nodiscard]] ShaderProgram build() const
+  template <typename T>
+  ShaderBuilder& define(const std::string& name, const T& value)
   {
-    return ShaderProgram{shaders_};
+    defines_.insert_or_assign(name, fmt::to_string(value));
+    return *this;
+  }
+
+  ShaderBuilder& define(const std::string& name)
+  {
+    defines_.insert_or_assign(name, std::string{});
+    return *this;
   }
 
+  /// Verifies after linking that the block laid out by the driver matches the
+  /// C++ side. `layout` must have static storage duration
+  ShaderBuilder& expect_layout(const BufferBlockLayout& layout)
+  {
+    layouts_.push_back(&layout);
+    return *this;
+  }
+
+  /// Uniquely identifies the stages and the define set
+  [[nodiscard]] std::string key() const;
+
+  [[nodiscard]] ShaderProgram build() const;
+
+  /// The first half of build(), safe to run on any thread
+  [[nodiscard]] PreprocessedProgram preprocess() const;
+  /// The second half of build(): submits the compile and link of `program`
+  [[nodiscard]] ShaderProgram submit(const PreprocessedProgram& program) const;
+
+private:
+  struct Stage {
+    std::string filename;
+    Shader::Type type;
+  };
+
+  std::vector<Stage> stages_;
+  // Ordered so that the key does not depend on the order of define() calls
+  std::map<std::string, std::string> defines_;
+  std::vector<const BufferBlockLayout*> layouts_;
+};
+
+/**
+ * @brief Caches compiled permutations of shader programs
+ *
+ * Programs are keyed by ShaderBuilder::key(), so each combination of stages
+ * and defines is only compiled once.
+ */
+class ShaderCache {
+public:
+  /// Registers every program built from now on for hot-reloading
+  void set_watcher(ShaderWatcher* watcher) noexcept
+  {
+    watcher_ = watcher;
+  }
+
+  /// Returns the program built from `builder`, submitting it on first use.
+  /// The returned program may still need ShaderProgram::finalize()
+  [[nodiscard]] ShaderProgram& get(const ShaderBuilder& builder);
+
+  [[nodiscard]] bool ready() const;
+  void finalize();
+
 private:
-  std::vector<Shader> shaders_;
+  // Node-based so that references to the programs stay valid
+  std::unordered_map<std::string, ShaderProgram> programs_;
+  ShaderWatcher* watcher_ = nullptr;
 };
 
 #endif // SHADER_HPP
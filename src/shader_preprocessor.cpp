@@ -0,0 +1,110 @@
+#include "shader_preprocessor.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace {
+
+[[nodiscard]] std::string_view parent_directory(std::string_view path)
+{
+  const auto slash = path.find_last_of('/');
+  return slash == std::string_view::npos ? std::string_view{}
+                                         : path.substr(0, slash + 1);
+}
+
+// Returns the quoted path of an `#include "path"` line, or an empty view
+[[nodiscard]] std::string_view parse_include(std::string_view line)
+{
+  const auto first = line.find_first_not_of(" \t");
+  if (first == std::string_view::npos || line[first] != '#') {
+    return {};
+  }
+  line.remove_prefix(first + 1);
+  line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size()));
+
+  constexpr std::string_view directive = "include";
+  if (!line.starts_with(directive)) {
+    return {};
+  }
+  const auto open = line.find('"');
+  const auto close = line.find('"', open + 1);
+  if (open == std::string_view::npos || close == std::string_view::npos) {
+    throw std::runtime_error{
+        fmt::format("Malformed #include directive: {}", line)};
+  }
+  return line.substr(open + 1, close - open - 1);
+}
+
+void expand_includes(const std::string& filename,
+                     const std::map<std::string, std::string>& defines,
+                     const ShaderSourceLoader& load, PreprocessedSource& out,
+                     std::vector<std::string>& include_stack)
+{
+  if (std::find(include_stack.begin(), include_stack.end(), filename) !=
+      include_stack.end()) {
+    throw std::runtime_error{
+        fmt::format("Recursive #include of {}", filename)};
+  }
+  include_stack.push_back(filename);
+
+  const auto file_index = out.files.size();
+  out.files.push_back(filename);
+
+  const std::string source = load(filename);
+  std::istringstream stream{source};
+  std::string line;
+  for (std::size_t line_number = 1; std::getline(stream, line);
+       ++line_number) {
+    if (const auto include = parse_include(line); !include.empty()) {
+      const auto path =
+          std::string{parent_directory(filename)} + std::string{include};
+      out.source += fmt::format("#line 1 {}\n", out.files.size());
+      expand_includes(path, defines, load, out, include_stack);
+      out.source += fmt::format("#line {} {}\n", line_number + 1, file_index);
+      continue;
+    }
+
+    out.source += line;
+    out.source += '\n';
+
+    // Defines must come after #version, which has to be the first directive
+    if (include_stack.size() == 1 && line.starts_with("#version")) {
+      for (const auto& [name, value] : defines) {
+        out.source += fmt::format("#define {} {}\n", name, value);
+      }
+      out.source += fmt::format("#line {} {}\n", line_number + 1, file_index);
+    }
+  }
+
+  include_stack.pop_back();
+}
+
+} // anonymous namespace
+
+std::string PreprocessedSource::describe() const
+{
+  std::string name = files.front();
+  if (files.size() > 1) {
+    name += " (source strings:";
+    for (std::size_t i = 0; i < files.size(); ++i) {
+      name += fmt::format(" {}={}", i, files[i]);
+    }
+    name += ")";
+  }
+  return name;
+}
+
+PreprocessedSource
+preprocess_shader(const std::string& filename,
+                  const std::map<std::string, std::string>& defines,
+                  const ShaderSourceLoader& load)
+{
+  PreprocessedSource result;
+  std::vector<std::string> include_stack;
+  expand_includes(filename, defines, load, result, include_stack);
+  return result;
+}
@@ -0,0 +1,37 @@
+#ifndef GLGRASSRENDERER_SHADER_PREPROCESSOR_HPP
+#define GLGRASSRENDERER_SHADER_PREPROCESSOR_HPP
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Kept free of OpenGL so that the build-time shader tools can share it
+
+struct PreprocessedSource {
+  std::string source;
+  // Indexed by the source string number used in #line directives
+  std::vector<std::string> files;
+
+  /// Names the stage in error messages, including which file each source
+  /// string number in the driver's log refers to
+  [[nodiscard]] std::string describe() const;
+};
+
+/// Returns the contents of a shader file given its path relative to the data
+/// directory
+using ShaderSourceLoader = std::function<std::string(const std::string&)>;
+
+/**
+ * @brief Expands `#include "file"` directives and injects defines
+ *
+ * Includes are resolved relative to the including file and are wrapped in
+ * #line directives. Every define is emitted right after the `#version` line.
+ * Throws std::runtime_error on recursive or malformed includes.
+ */
+[[nodiscard]] PreprocessedSource
+preprocess_shader(const std::string& filename,
+                  const std::map<std::string, std::string>& defines,
+                  const ShaderSourceLoader& load);
+
+#endif // GLGRASSRENDERER_SHADER_PREPROCESSOR_HPP
@@ -0,0 +1,172 @@
+#include "shader_watcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include <fmt/format.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+ShaderWatcher::ShaderWatcher()
+{
+#ifdef __linux__
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ < 0) {
+    fmt::print(stderr, "Shader hot-reloading disabled: inotify_init1 failed\n");
+  }
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+#ifdef __linux__
+  if (inotify_fd_ >= 0) {
+    close(inotify_fd_);
+  }
+#endif
+}
+
+void ShaderWatcher::watch(ShaderProgram& program, ShaderBuilder builder)
+{
+  if (inotify_fd_ < 0) {
+    return;
+  }
+
+  add_watches(program);
+  entries_.push_back({&program, std::move(builder), {}, false, std::nullopt});
+}
+
+void ShaderWatcher::add_watches(const ShaderProgram& program)
+{
+#ifdef __linux__
+  for (const auto& file : program.source_files()) {
+    const auto slash = file.find_last_of('/');
+    const std::string directory =
+        slash == std::string::npos ? std::string{} : file.substr(0, slash + 1);
+
+    // Editors often replace files by renaming, which IN_CLOSE_WRITE misses
+    const int wd = inotify_add_watch(
+        inotify_fd_, directory.empty() ? "." : directory.c_str(),
+        IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd >= 0) {
+      directories_.insert_or_assign(wd, directory);
+    }
+  }
+#else
+  (void)program;
+#endif
+}
+
+std::vector<std::string> ShaderWatcher::read_changed_files()
+{
+  std::vector<std::string> changed;
+
+#ifdef __linux__
+  alignas(inotify_event) char buffer[4096];
+  for (;;) {
+    const auto length = read(inotify_fd_, buffer, sizeof(buffer));
+    if (length <= 0) {
+      break;
+    }
+
+    for (auto offset = 0l; offset < length;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(
+          buffer + static_cast<std::size_t>(offset));
+      if (event->len > 0) {
+        if (const auto it = directories_.find(event->wd);
+            it != directories_.end()) {
+          changed.push_back(it->second + event->name);
+        }
+      }
+      offset += static_cast<long>(sizeof(inotify_event) + event->len);
+    }
+  }
+#endif
+
+  return changed;
+}
+
+void ShaderWatcher::poll()
+{
+  if (inotify_fd_ < 0) {
+    return;
+  }
+
+  // A rebuild advances at most one stage per poll, so that no stage waits on
+  // the background work of the one before
+  for (auto& entry : entries_) {
+    swap_rebuilt(entry);
+    submit_preprocessed(entry);
+  }
+
+  const auto changed = read_changed_files();
+  for (const auto& file : changed) {
+    mark_shader_source_modified(file);
+  }
+  for (auto& entry : entries_) {
+    const auto& sources = entry.program->source_files();
+    const bool affected =
+        std::any_of(changed.begin(), changed.end(), [&](const auto& file) {
+          return std::find(sources.begin(), sources.end(), file) !=
+                 sources.end();
+        });
+    if (!affected) {
+      continue;
+    }
+
+    if (entry.preprocessing.valid()) {
+      entry.stale = true;
+    } else {
+      entry.preprocessing = std::async(
+          std::launch::async,
+          [builder = entry.builder] { return builder.preprocess(); });
+    }
+  }
+}
+
+void ShaderWatcher::submit_preprocessed(Entry& entry)
+{
+  if (!entry.preprocessing.valid() ||
+      entry.preprocessing.wait_for(std::chrono::seconds{0}) !=
+          std::future_status::ready) {
+    return;
+  }
+
+  try {
+    const PreprocessedProgram preprocessed = entry.preprocessing.get();
+    if (entry.stale) {
+      // Read before the last change, start over
+      entry.stale = false;
+      entry.preprocessing = std::async(
+          std::launch::async,
+          [builder = entry.builder] { return builder.preprocess(); });
+      return;
+    }
+    entry.rebuilt = entry.builder.submit(preprocessed);
+  } catch (const std::exception& e) {
+    entry.stale = false;
+    fmt::print(stderr, "Shader reload failed: {}\n", e.what());
+  }
+}
+
+void ShaderWatcher::swap_rebuilt(Entry& entry)
+{
+  if (!entry.rebuilt || !entry.rebuilt->ready()) {
+    return;
+  }
+
+  try {
+    entry.rebuilt->finalize();
+    *entry.program = std::move(*entry.rebuilt);
+    // The new sources may include files that were not watched before
+    add_watches(*entry.program);
+    fmt::print("Reloaded shader {}\n", entry.builder.key());
+  } catch (const std::exception& e) {
+    fmt::print(stderr, "Shader reload failed, keeping the old program: {}\n",
+               e.what());
+  }
+  entry.rebuilt.reset();
+}
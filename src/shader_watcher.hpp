@@ -0,0 +1,63 @@
+#ifndef GLGRASSRENDERER_SHADER_WATCHER_HPP
+#define GLGRASSRENDERER_SHADER_WATCHER_HPP
+
+#include "shader.hpp"
+
+#include <future>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Rebuilds shader programs when their source files change
+ *
+ * Uses inotify to watch the directories of every source file, including the
+ * ones pulled in by `#include`. Only the programs that depend on a changed
+ * file are rebuilt. The sources are preprocessed on a background thread, and
+ * the compile and link are submitted on a later poll(), which swaps the new
+ * program in once GL_COMPLETION_STATUS reports it done. On error the old
+ * program is kept and the log is printed.
+ *
+ * Hot-reloading is only supported on Linux, elsewhere this class does nothing.
+ */
+class ShaderWatcher {
+public:
+  ShaderWatcher();
+  ~ShaderWatcher();
+
+  ShaderWatcher(const ShaderWatcher& other) = delete;
+  ShaderWatcher& operator=(const ShaderWatcher& other) = delete;
+  ShaderWatcher(ShaderWatcher&& other) = delete;
+  ShaderWatcher& operator=(ShaderWatcher&& other) = delete;
+
+  /// `program` must outlive the watcher, and must have been built by `builder`
+  void watch(ShaderProgram& program, ShaderBuilder builder);
+
+  /// Picks up file changes, submits the rebuilds whose preprocessing is done
+  /// and swaps in the ones that finished linking. Never blocks when parallel
+  /// shader compiling is available. Call once per frame
+  void poll();
+
+private:
+  struct Entry {
+    ShaderProgram* program;
+    ShaderBuilder builder;
+    std::future<PreprocessedProgram> preprocessing;
+    /// A source changed again while it was being preprocessed
+    bool stale = false;
+    std::optional<ShaderProgram> rebuilt;
+  };
+
+  int inotify_fd_ = -1;
+  // inotify watch descriptor to directory prefix
+  std::unordered_map<int, std::string> directories_;
+  std::vector<Entry> entries_;
+
+  void add_watches(const ShaderProgram& program);
+  void swap_rebuilt(Entry& entry);
+  void submit_preprocessed(Entry& entry);
+  [[nodiscard]] std::vector<std::string> read_changed_files();
+};
+
+#endif // GLGRASSRENDERER_SHADER_WATCHER_HPP
@@ -0,0 +1,80 @@
+#include "simulation.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+
+Simulation::Simulation(const Camera& camera) : camera_{camera} {}
+
+void Simulation::step(const SimulationInput& input, DeltaDuration delta_time)
+{
+  const glm::vec2 look = input.look - input_.look;
+  if (look != glm::vec2{0.0f}) {
+    camera_.mouse_movement(look.x, look.y);
+  }
+  const float scroll = input.scroll - input_.scroll;
+  if (scroll != 0) {
+    camera_.mouse_scroll(scroll);
+  }
+
+  camera_.set_speed(input.camera_speed);
+  if (input.forward) {
+    camera_.move(Camera::Movement::forward, delta_time);
+  }
+  if (input.backward) {
+    camera_.move(Camera::Movement::backward, delta_time);
+  }
+  if (input.left) {
+    camera_.move(Camera::Movement::left, delta_time);
+  }
+  if (input.right) {
+    camera_.move(Camera::Movement::right, delta_time);
+  }
+
+  input_ = input;
+  time_ += delta_time.count() / 1e3f;
+  ++step_;
+}
+
+SimulationSnapshot Simulation::snapshot() const
+{
+  return {step_,
+          time_,
+          camera_.position(),
+          camera_.view_matrix(),
+          camera_.zoom(),
+          input_.wind_magnitude,
+          input_.wind_wave_length,
+          input_.wind_wave_period};
+}
+
+SimulationThread::SimulationThread(Simulation& simulation, double rate)
+    : simulation_{simulation}, period_{1 / rate},
+      snapshots_{simulation.snapshot()}, worker_{[this] { work(); }}
+{
+}
+
+SimulationThread::~SimulationThread()
+{
+  stopping_ = true;
+  worker_.join();
+}
+
+void SimulationThread::work()
+{
+  PROFILE_THREAD("simulation");
+  const auto period =
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(period_);
+  auto next_step = std::chrono::steady_clock::now();
+  while (!stopping_.load(std::memory_order_relaxed)) {
+    {
+      PROFILE_ZONE("simulation_step");
+      simulation_.step(input_.read(), period_);
+      snapshots_.write(simulation_.snapshot());
+    }
+
+    // A step that fell behind is not made up for, the world slows down
+    // instead of stepping in bursts
+    next_step = std::max(next_step + period, std::chrono::steady_clock::now());
+    std::this_thread::sleep_until(next_step);
+  }
+}
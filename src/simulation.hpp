@@ -0,0 +1,117 @@
+#ifndef GLGRASSRENDERER_SIMULATION_HPP
+#define GLGRASSRENDERER_SIMULATION_HPP
+
+#include "camera.hpp"
+#include "triple_buffer.hpp"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+/// What the window thread gathers for the simulation. Cursor and wheel
+/// motion are accumulated rather than reset, so that nothing is lost when
+/// several inputs are published between two steps
+struct SimulationInput {
+  bool forward = false;
+  bool backward = false;
+  bool left = false;
+  bool right = false;
+  /// Cursor motion while turning the camera, in pixels
+  glm::vec2 look{0.0f};
+  float scroll = 0;
+
+  float camera_speed = Camera::initial_speed;
+  float wind_magnitude = 1;
+  float wind_wave_length = 1;
+  float wind_wave_period = 1;
+};
+
+/// The world after one simulation step, never changed once published
+struct SimulationSnapshot {
+  std::uint64_t step = 0;
+  /// Seconds simulated so far, drives the wind
+  float time = 0;
+
+  glm::vec3 camera_position{0.0f};
+  glm::mat4 view{1.0f};
+  /// Vertical field of view in degrees
+  float zoom = Camera::init_zoom;
+
+  float wind_magnitude = 1;
+  float wind_wave_length = 1;
+  float wind_wave_period = 1;
+};
+
+/// Advances the camera, the wind and the clock of the world
+class Simulation {
+public:
+  using DeltaDuration = std::chrono::duration<float, std::milli>;
+
+  explicit Simulation(const Camera& camera);
+
+  void step(const SimulationInput& input, DeltaDuration delta_time);
+
+  /// For scripted paths, which place the camera themselves
+  [[nodiscard]] Camera& camera() noexcept
+  {
+    return camera_;
+  }
+
+  [[nodiscard]] SimulationSnapshot snapshot() const;
+
+private:
+  Camera camera_;
+  /// The input of the last step, whose accumulated motion was applied
+  SimulationInput input_;
+  std::uint64_t step_ = 0;
+  float time_ = 0;
+};
+
+/**
+ * @brief Steps a Simulation at a fixed rate on its own thread
+ *
+ * Input comes in and snapshots go out through triple buffers, so neither
+ * the window thread nor the simulation ever waits for the other. The window
+ * thread renders the latest snapshot, which is at most one step old.
+ */
+class SimulationThread {
+public:
+  static constexpr double default_rate = 120;
+
+  /// Only the thread touches `simulation` until it is destroyed
+  SimulationThread(Simulation& simulation, double rate);
+  ~SimulationThread();
+
+  SimulationThread(const SimulationThread&) = delete;
+  SimulationThread& operator=(const SimulationThread&) = delete;
+  SimulationThread(SimulationThread&&) = delete;
+  SimulationThread& operator=(SimulationThread&&) = delete;
+
+  /// From one thread only
+  void publish_input(const SimulationInput& input)
+  {
+    input_.write(input);
+  }
+
+  /// From one thread only. Valid until the next call
+  [[nodiscard]] const SimulationSnapshot& latest() noexcept
+  {
+    return snapshots_.read();
+  }
+
+private:
+  Simulation& simulation_;
+  std::chrono::duration<double> period_;
+  TripleBuffer<SimulationInput> input_;
+  TripleBuffer<SimulationSnapshot> snapshots_;
+  std::atomic<bool> stopping_{false};
+  // Started last, once everything it uses is constructed
+  std::thread worker_;
+
+  void work();
+};
+
+#endif // GLGRASSRENDERER_SIMULATION_HPP
@@ -0,0 +1,178 @@
+#include "terrain.hpp"
+#include "gl_extensions.hpp"
+#include "gl_state.hpp"
+#include "profiler.hpp"
+
+#include <glm/gtc/noise.hpp>
+
+#include <algorithm>
+
+namespace {
+
+/// Fractal noise mapped to [0, 1]. Normalized by the total amplitude rather
+/// than by the range of a tile, so that every tile uses the same mapping
+[[nodiscard]] float noise_height(glm::vec2 position)
+{
+  constexpr int octaves = 5;
+  constexpr float base_wavelength = 24.0f;
+
+  float height = 0.0f;
+  float amplitude = 1.0f;
+  float amplitude_sum = 0.0f;
+  float frequency = 1.0f / base_wavelength;
+  for (int octave = 0; octave < octaves; ++octave) {
+    height += amplitude * glm::simplex(position * frequency);
+    amplitude_sum += amplitude;
+    amplitude *= 0.45f;
+    frequency *= 2.0f;
+  }
+  // The sum rarely gets near its bounds, stretch it to use the whole range
+  return std::clamp(0.5f + 0.75f * height / amplitude_sum, 0.0f, 1.0f);
+}
+
+} // anonymous namespace
+
+void Terrain::init(ResourceManager& resources)
+{
+  PROFILE_ZONE("init_terrain");
+  constexpr std::size_t layer_size =
+      std::size_t{heightmap_resolution} * heightmap_resolution * sizeof(float);
+  heightmaps_ = resources.create_texture_array(
+      "Terrain", "terrain/heightmaps", heightmap_resolution,
+      heightmap_resolution, max_tiles, GL_R32F, layer_size * max_tiles);
+  for (int layer = max_tiles - 1; layer >= 0; --layer) {
+    free_layers_.push_back(layer);
+  }
+
+  ground_texture_ =
+      resources.load_texture("Terrain", "GrassGreenTexture0001.jpg");
+  // The ground repeats every meter, so distant patches read from its mips
+  ground_sampler_ = std::make_unique<Sampler>();
+  ground_sampler_->parameter(GL_TEXTURE_WRAP_S, GL_REPEAT);
+  ground_sampler_->parameter(GL_TEXTURE_WRAP_T, GL_REPEAT);
+  ground_sampler_->parameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  ground_sampler_->parameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  tile_buffer_ = resources.buffer("Terrain", "terrain/tiles",
+                                 sizeof(TileEntry) * max_tiles, nullptr,
+                                 GL_DYNAMIC_STORAGE_BIT);
+
+  // The patch corners are computed from gl_VertexID, but core profile still
+  // needs a vertex array bound to draw
+  vertex_array_ = std::make_unique<VertexArray>();
+
+  shader_ = &resources.program(
+      ShaderBuilder{}
+          .load("terrain.vert.glsl", Shader::Type::Vertex)
+          .load("terrain.tesc.glsl", Shader::Type::TessControl)
+          .load("terrain.tese.glsl", Shader::Type::TessEval)
+          .load("terrain.frag.glsl", Shader::Type::Fragment)
+          .expect_layout(camera_buffer_layout)
+          .expect_layout(terrain_buffer_layout)
+          .expect_layout(terrain_tiles_layout));
+}
+
+std::vector<float> Terrain::generate_tile(TileCoord coord)
+{
+  PROFILE_ZONE("generate_heightmap");
+  constexpr float spacing = tile_size / (tile_samples - 1);
+
+  std::vector<float> heights(std::size_t{heightmap_resolution} *
+                             heightmap_resolution);
+  for (int y = 0; y < heightmap_resolution; ++y) {
+    for (int x = 0; x < heightmap_resolution; ++x) {
+      // From the index of the sample in the whole world, so that neighbouring
+      // tiles compute bit-identical heights along their shared edge
+      const int world_x = coord.x * (tile_samples - 1) + x - 1;
+      const int world_z = coord.z * (tile_samples - 1) + y - 1;
+      heights[static_cast<std::size_t>(y * heightmap_resolution + x)] =
+          noise_height(glm::vec2(static_cast<float>(world_x) * spacing,
+                                 static_cast<float>(world_z) * spacing));
+    }
+  }
+  return heights;
+}
+
+float Terrain::height_at(glm::vec2 xz)
+{
+  return noise_height(xz) * height_scale;
+}
+
+bool Terrain::add_tile(TileCoord coord, std::span<const float> heights)
+{
+  if (free_layers_.empty() || tiles_.contains(coord)) {
+    return false;
+  }
+  const int layer = free_layers_.back();
+  free_layers_.pop_back();
+  tiles_.emplace(coord, layer);
+  tiles_changed_ = true;
+
+  glTextureSubImage3D(heightmaps_.id(), 0, 0, 0, layer, heightmap_resolution,
+                      heightmap_resolution, 1, GL_RED, GL_FLOAT,
+                      heights.data());
+  return true;
+}
+
+void Terrain::remove_tile(TileCoord coord)
+{
+  if (const auto it = tiles_.find(coord); it != tiles_.end()) {
+    free_layers_.push_back(it->second);
+    tiles_.erase(it);
+    tiles_changed_ = true;
+  }
+}
+
+std::optional<int> Terrain::layer_of(TileCoord coord) const
+{
+  if (const auto it = tiles_.find(coord); it != tiles_.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+void Terrain::bind(UploadRing& uploads)
+{
+  uploads.bind_uniforms(1, TerrainBufferObject{tile_size, height_scale,
+                                               tessellation_factor,
+                                               patches_per_side});
+
+  gl_state().bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 4, tile_buffer_->id());
+  if (tiles_changed_) {
+    // Instance i draws entry i, so only the resident tiles are listed
+    std::vector<TileEntry> entries;
+    entries.reserve(tiles_.size());
+    for (const auto& [coord, layer] : tiles_) {
+      entries.push_back({glm::ivec2(coord.x, coord.z), layer, 1});
+    }
+    tile_buffer_->update(
+        0, static_cast<GLsizeiptr>(entries.size() * sizeof(TileEntry)),
+        entries.data());
+    tiles_changed_ = false;
+  }
+
+  gl_state().bind_texture_unit(1, heightmaps_.id());
+}
+
+void Terrain::render()
+{
+  if (tiles_.empty()) {
+    return;
+  }
+  if (wireframe) {
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+  }
+
+  shader_->use();
+  vertex_array_->bind();
+  gl_state().bind_texture_unit(2, ground_texture_.id());
+  ground_sampler_->bind(2);
+  glPatchParameteri(GL_PATCH_VERTICES, 4);
+  glDrawArraysInstanced(
+      GL_PATCHES, 0,
+      static_cast<GLsizei>(4 * patches_per_side * patches_per_side),
+      static_cast<GLsizei>(tiles_.size()));
+
+  if (wireframe) {
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+  }
+}
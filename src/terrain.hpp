@@ -0,0 +1,95 @@
+#ifndef GLGRASSRENDERER_TERRAIN_HPP
+#define GLGRASSRENDERER_TERRAIN_HPP
+
+#include "gpu_types.hpp"
+#include "resource_manager.hpp"
+#include "shader.hpp"
+#include "texture.hpp"
+#include "tile_coord.hpp"
+#include "upload_ring.hpp"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Heightmap terrain streamed in tiles and rendered as tessellated
+ * patches
+ *
+ * Each resident tile owns one layer of a heightmap array texture. The layers
+ * form a fixed pool: a tile takes a free layer when it is added and returns
+ * it when it is evicted, so the terrain's VRAM does not grow with the
+ * distance travelled. Heights are generated from world-space noise, which
+ * makes any tile reproducible and seamless with its neighbours.
+ *
+ * Every tile is a grid of quad patches that the tessellator subdivides by
+ * distance to the camera, so triangle density follows the view instead of
+ * the size of the world. Patches outside of the frustum are discarded before
+ * tessellation. The grass compute shader samples the same heightmaps to
+ * plant the blades.
+ */
+class Terrain {
+public:
+  static constexpr float tile_size = 16.0f;
+  static constexpr float height_scale = 4.0f;
+  /// Heightmap samples across a tile from edge to edge. The layers add one
+  /// sample outside of each edge for the normals
+  static constexpr int tile_samples = 65;
+  static constexpr int heightmap_resolution = tile_samples + 2;
+  /// Rings of tiles kept around the camera's tile
+  static constexpr int tile_radius = 5;
+  static constexpr int max_tiles =
+      (2 * tile_radius + 1) * (2 * tile_radius + 1);
+
+  // Tessellation level of a 1 m edge seen from 1 m away
+  float tessellation_factor = 16.0f;
+  GLuint patches_per_side = 4;
+  bool wireframe = false;
+
+  Terrain() = default;
+  ~Terrain() = default;
+
+  Terrain(const Terrain&) = delete;
+  Terrain& operator=(const Terrain&) = delete;
+  Terrain(Terrain&&) = delete;
+  Terrain& operator=(Terrain&&) = delete;
+
+  void init(ResourceManager& resources);
+
+  /// Generates the heightmap layer of `coord`. Safe to call from any thread
+  [[nodiscard]] static std::vector<float> generate_tile(TileCoord coord);
+
+  /// Height of the ground at `xz`, from the noise the tiles are sampled from
+  [[nodiscard]] static float height_at(glm::vec2 xz);
+
+  /// Uploads the heights of `coord` into a free layer. Returns false when
+  /// every layer is taken
+  bool add_tile(TileCoord coord, std::span<const float> heights);
+  void remove_tile(TileCoord coord);
+
+  /// The heightmap layer of `coord`, if it is resident
+  [[nodiscard]] std::optional<int> layer_of(TileCoord coord) const;
+
+  /// Uploads and binds the terrain uniforms, and binds the tile table and
+  /// the heightmaps for the terrain and grass shaders. Call once per frame
+  /// before either is drawn or dispatched
+  void bind(UploadRing& uploads);
+  void render();
+
+private:
+  std::unique_ptr<VertexArray> vertex_array_;
+  ShaderProgram* shader_ = nullptr;
+  std::shared_ptr<Buffer> tile_buffer_;
+  TextureHandle heightmaps_;
+  TextureHandle ground_texture_;
+  std::unique_ptr<Sampler> ground_sampler_;
+  std::unordered_map<TileCoord, int, TileCoordHash> tiles_;
+  std::vector<int> free_layers_;
+  bool tiles_changed_ = false;
+};
+
+#endif // GLGRASSRENDERER_TERRAIN_HPP
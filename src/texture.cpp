@@ -1,4 +1,11 @@
 #include "texture.hpp"
+#include "asset_pack.hpp"
+#include "bc1.hpp"
+#include "gl_objects.hpp"
+#include "gl_extensions.hpp"
+#include "gl_state.hpp"
+#include "ktx2.hpp"
+#include "profiler.hpp"
 
 #include <glad/glad.h>
 
@@ -9,29 +16,498 @@
 
 #include <fmt/format.h>
 
-unsigned int load_texture(std::string_view s)
-{
-  unsigned int texture;
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
-  // set the texture wrapping parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-  // set texture filtering parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  // load image, create texture and generate mipmaps
-  int width, height, nrChannels;
-  stbi_set_flip_vertically_on_load(
-      true); // tell stb_image.h to flip loaded texture's on the y-axis.
-  unsigned char* data = stbi_load(s.data(), &width, &height, &nrChannels, 0);
-  if (data) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB,
-                 GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+namespace {
+
+constexpr GLbitfield staging_flags =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+struct ImageDeleter {
+  void operator()(unsigned char* data) const noexcept
+  {
+    stbi_image_free(data);
+  }
+};
+
+struct DecodedImage {
+  int width = 0;
+  int height = 0;
+  int channels = 0;
+  /// 0 for uncompressed pixels
+  GLenum compressed_format = 0;
+  /// The whole mip chain when compressed, the base level otherwise
+  std::vector<std::span<const unsigned char>> levels;
+
+  // Own the bytes `levels` points into
+  std::unique_ptr<unsigned char, ImageDeleter> pixels;
+  std::vector<unsigned char> decompressed;
+  std::optional<Asset> asset;
+
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    std::size_t total = 0;
+    for (const auto& level : levels) {
+      total += level.size();
+    }
+    return total;
+  }
+};
+
+[[nodiscard]] DecodedImage decode_ktx2(Asset asset)
+{
+  const auto texture = read_ktx2({asset.data(), asset.size()});
+  if (texture.face_count != 1) {
+    throw std::runtime_error{"Expected a single face"};
+  }
+
+  DecodedImage image;
+  image.width = static_cast<int>(texture.width);
+  image.height = static_cast<int>(texture.height);
+  if (gl_extensions().texture_compression_s3tc) {
+    image.compressed_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    image.levels = texture.levels;
+    image.asset = std::move(asset);
   } else {
-    fmt::print(stderr, "Failed to load texture \"{}\"\n", s);
+    // Only the base level, the rest of the chain is generated on upload
+    image.channels = 4;
+    image.decompressed =
+        bc1_decompress(texture.levels.front(), texture.width, texture.height);
+    image.levels.emplace_back(image.decompressed);
+  }
+  return image;
+}
+
+[[nodiscard]] DecodedImage decode_image(const std::string& path, bool flip)
+{
+  PROFILE_ZONE("decode_image");
+  // Prefer the block-compressed version made by the compress_texture tool,
+  // which already has the orientation we need and a full mip chain
+  const auto ktx2_path =
+      std::filesystem::path{path}.replace_extension(".ktx2").generic_string();
+  if (auto asset = load_asset(ktx2_path)) {
+    try {
+      return decode_ktx2(std::move(*asset));
+    } catch (const std::exception& e) {
+      fmt::print(stderr, "Failed to load texture \"{}\": {}\n", ktx2_path,
+                 e.what());
+    }
   }
-  stbi_image_free(data);
-  return texture;
+
+  DecodedImage image;
+  if (const auto asset = load_asset(path)) {
+    stbi_set_flip_vertically_on_load_thread(flip);
+    image.pixels.reset(stbi_load_from_memory(
+        asset->data(), static_cast<int>(asset->size()), &image.width,
+        &image.height, &image.channels, 0));
+  }
+  if (image.pixels == nullptr) {
+    fmt::print(stderr, "Failed to load texture \"{}\"\n", path);
+    return image;
+  }
+
+  const auto size = static_cast<std::size_t>(image.width) *
+                    static_cast<std::size_t>(image.height) *
+                    static_cast<std::size_t>(image.channels);
+  image.levels.emplace_back(image.pixels.get(), size);
+  return image;
+}
+
+[[nodiscard]] GLenum pixel_format(int channels)
+{
+  switch (channels) {
+  case 1:
+    return GL_RED;
+  case 2:
+    return GL_RG;
+  case 4:
+    return GL_RGBA;
+  default:
+    return GL_RGB;
+  }
+}
+
+[[nodiscard]] GLenum internal_format(int channels)
+{
+  switch (channels) {
+  case 1:
+    return GL_R8;
+  case 2:
+    return GL_RG8;
+  case 4:
+    return GL_RGBA8;
+  default:
+    return GL_RGB8;
+  }
+}
+
+/// Drivers pad RGB8 texels to four bytes
+[[nodiscard]] std::size_t stored_texel_size(int channels)
+{
+  return channels == 3 ? 4 : static_cast<std::size_t>(channels);
+}
+
+[[nodiscard]] GLsizei mip_levels(int width, int height)
+{
+  const auto size = static_cast<float>(std::max(width, height));
+  return static_cast<GLsizei>(std::floor(std::log2(size))) + 1;
+}
+
+} // anonymous namespace
+
+struct TextureRequest {
+  GLenum target = GL_TEXTURE_2D;
+  bool flip = false;
+  std::vector<std::string> paths;
+  // Written by the workers, one image each
+  std::vector<DecodedImage> images;
+  std::size_t remaining = 0;
+
+  Texture texture;
+  std::size_t memory_size = 0;
+};
+
+bool TextureHandle::ready() const noexcept
+{
+  return request_ != nullptr && request_->texture.id() != 0;
+}
+
+GLuint TextureHandle::id() const noexcept
+{
+  return request_ != nullptr ? request_->texture.id() : 0;
+}
+
+std::size_t TextureHandle::memory_size() const noexcept
+{
+  return request_ != nullptr ? request_->memory_size : 0;
+}
+
+TextureLoader::TextureLoader(std::size_t staging_size)
+    : staging_buffer_{static_cast<GLsizeiptr>(staging_size), nullptr,
+                      staging_flags}
+{
+  staging_memory_ = static_cast<unsigned char*>(glMapNamedBufferRange(
+      staging_buffer_.id(), 0, staging_buffer_.size(), staging_flags));
+  staging_size_ = staging_memory_ != nullptr ? staging_size : 0;
+
+  const auto worker_count =
+      std::clamp(std::thread::hardware_concurrency(), 2u, 5u) - 1;
+  for (unsigned i = 0; i < worker_count; ++i) {
+    workers_.emplace_back([this] { work(); });
+  }
+}
+
+TextureLoader::~TextureLoader()
+{
+  {
+    std::lock_guard lock{mutex_};
+    stopping_ = true;
+  }
+  jobs_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+
+  for (const auto& upload : in_flight_) {
+    glDeleteSync(upload.fence);
+  }
+  if (staging_memory_ != nullptr) {
+    glUnmapNamedBuffer(staging_buffer_.id());
+  }
+}
+
+TextureHandle TextureLoader::load_texture(std::string_view path)
+{
+  auto request = std::make_shared<TextureRequest>();
+  request->target = GL_TEXTURE_2D;
+  request->flip = true;
+  request->paths.emplace_back(path);
+  submit(request);
+  return TextureHandle{std::move(request)};
+}
+
+TextureHandle TextureLoader::load_cubemap(std::vector<std::string> faces)
+{
+  auto request = std::make_shared<TextureRequest>();
+  request->target = GL_TEXTURE_CUBE_MAP;
+  request->paths = std::move(faces);
+  submit(request);
+  return TextureHandle{std::move(request)};
+}
+
+TextureHandle TextureLoader::create_texture(GLsizei width, GLsizei height,
+                                           GLenum internal_format,
+                                           GLenum format, GLenum type,
+                                           const void* pixels,
+                                           std::size_t memory_size)
+{
+  auto request = std::make_shared<TextureRequest>();
+  request->memory_size = memory_size;
+
+  Texture texture{GL_TEXTURE_2D};
+  glTextureStorage2D(texture.id(), 1, internal_format, width, height);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTextureSubImage2D(texture.id(), 0, 0, 0, width, height, format, type,
+                      pixels);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  texture.parameter(GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  texture.parameter(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  texture.parameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  texture.parameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  request->texture = std::move(texture);
+  return TextureHandle{std::move(request)};
+}
+
+TextureHandle TextureLoader::create_texture_array(GLsizei width,
+                                                 GLsizei height,
+                                                 GLsizei layers,
+                                                 GLenum internal_format,
+                                                 std::size_t memory_size)
+{
+  auto request = std::make_shared<TextureRequest>();
+  request->memory_size = memory_size;
+
+  Texture texture{GL_TEXTURE_2D_ARRAY};
+  glTextureStorage3D(texture.id(), 1, internal_format, width, height, layers);
+  texture.parameter(GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  texture.parameter(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  texture.parameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  texture.parameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  request->texture = std::move(texture);
+  return TextureHandle{std::move(request)};
+}
+
+void TextureLoader::submit(std::shared_ptr<TextureRequest> request)
+{
+  request->images.resize(request->paths.size());
+  request->remaining = request->paths.size();
+  {
+    std::lock_guard lock{mutex_};
+    ++pending_requests_;
+    for (std::size_t i = 0; i < request->paths.size(); ++i) {
+      jobs_.push_back({request, i});
+    }
+  }
+  jobs_available_.notify_all();
+}
+
+void TextureLoader::work()
+{
+  PROFILE_THREAD("texture decoder");
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock lock{mutex_};
+      jobs_available_.wait(lock,
+                           [this] { return stopping_ || !jobs_.empty(); });
+      if (stopping_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+
+    auto& request = *job.request;
+    auto image = decode_image(request.paths[job.image_index], request.flip);
+
+    std::lock_guard lock{mutex_};
+    request.images[job.image_index] = std::move(image);
+    // Dropping the reference here could delete the texture without a GL
+    // context, when the other images have been decoded and uploaded since
+    auto& handed_back = --request.remaining == 0 ? decoded_ : released_;
+    handed_back.push_back(std::move(job.request));
+  }
+}
+
+void TextureLoader::update()
+{
+  retire_uploads();
+
+  std::vector<std::shared_ptr<TextureRequest>> released;
+  {
+    std::lock_guard lock{mutex_};
+    uploads_.insert(uploads_.end(), decoded_.begin(), decoded_.end());
+    decoded_.clear();
+    released.swap(released_);
+  }
+
+  // Uploads are kept in order; one that does not fit in the staging ring
+  // waits for earlier uploads to retire
+  while (!uploads_.empty() && upload(*uploads_.front())) {
+    uploads_.pop_front();
+    std::lock_guard lock{mutex_};
+    --pending_requests_;
+  }
+}
+
+bool TextureLoader::idle() const
+{
+  std::lock_guard lock{mutex_};
+  return pending_requests_ == 0;
+}
+
+void TextureLoader::retire_uploads()
+{
+  while (!in_flight_.empty()) {
+    const auto status = glClientWaitSync(in_flight_.front().fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+      break;
+    }
+    glDeleteSync(in_flight_.front().fence);
+    in_flight_.pop_front();
+  }
+}
+
+unsigned char* TextureLoader::allocate_staging(std::size_t size,
+                                               std::size_t& offset)
+{
+  if (size > staging_size_) {
+    return nullptr;
+  }
+
+  offset = staging_head_ + size <= staging_size_ ? staging_head_ : 0;
+  const bool overlaps = std::any_of(
+      in_flight_.begin(), in_flight_.end(), [&](const InFlightUpload& upload) {
+        return offset < upload.end && upload.begin < offset + size;
+      });
+  if (overlaps) {
+    return nullptr;
+  }
+
+  staging_head_ = offset + size;
+  return staging_memory_ + offset;
+}
+
+bool TextureLoader::upload(TextureRequest& request)
+{
+  PROFILE_ZONE("upload_texture");
+  const auto& first = request.images.front();
+  const bool complete =
+      std::all_of(request.images.begin(), request.images.end(),
+                  [&](const DecodedImage& image) {
+                    return !image.levels.empty() &&
+                           image.width == first.width &&
+                           image.height == first.height &&
+                           image.channels == first.channels &&
+                           image.compressed_format ==
+                               first.compressed_format &&
+                           image.levels.size() == first.levels.size();
+                  });
+  if (!complete) {
+    // The error has already been reported, leave the handle at id 0
+    return true;
+  }
+
+  std::size_t total_size = 0;
+  for (const auto& image : request.images) {
+    total_size += image.size();
+  }
+
+  // Images larger than the whole ring are uploaded from client memory
+  std::size_t offset = 0;
+  unsigned char* staging = nullptr;
+  if (total_size <= staging_size_) {
+    staging = allocate_staging(total_size, offset);
+    if (staging == nullptr) {
+      return false;
+    }
+    gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, staging_buffer_.id());
+  }
+
+  // Compressed images bring their own mip chain. Otherwise 2D textures get
+  // one generated after the upload
+  const bool compressed = first.compressed_format != 0;
+  const bool generate_mipmaps = !compressed && request.target == GL_TEXTURE_2D;
+  const GLsizei levels =
+      compressed         ? static_cast<GLsizei>(first.levels.size())
+      : generate_mipmaps ? mip_levels(first.width, first.height)
+                         : 1;
+  Texture texture{request.target};
+  glTextureStorage2D(texture.id(), levels,
+                     compressed ? first.compressed_format
+                                : internal_format(first.channels),
+                     first.width, first.height);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  for (std::size_t i = 0; i < request.images.size(); ++i) {
+    const auto& image = request.images[i];
+    // Cube map faces are the layers of the texture, in +X, -X, +Y, -Y, +Z,
+    // -Z order
+    const auto face = static_cast<GLint>(i);
+
+    for (std::size_t level = 0; level < image.levels.size(); ++level) {
+      const auto bytes = image.levels[level];
+      const void* pixels = bytes.data();
+      if (staging != nullptr) {
+        std::memcpy(staging, bytes.data(), bytes.size());
+        pixels = reinterpret_cast<const void*>(offset);
+        staging += bytes.size();
+        offset += bytes.size();
+      }
+
+      const auto gl_level = static_cast<GLint>(level);
+      const auto width = std::max(image.width >> level, 1);
+      const auto height = std::max(image.height >> level, 1);
+      const auto size = static_cast<GLsizei>(bytes.size());
+      if (request.target == GL_TEXTURE_CUBE_MAP && compressed) {
+        glCompressedTextureSubImage3D(texture.id(), gl_level, 0, 0, face,
+                                      width, height, 1,
+                                      image.compressed_format, size, pixels);
+      } else if (request.target == GL_TEXTURE_CUBE_MAP) {
+        glTextureSubImage3D(texture.id(), gl_level, 0, 0, face, width, height,
+                            1, pixel_format(image.channels), GL_UNSIGNED_BYTE,
+                            pixels);
+      } else if (compressed) {
+        glCompressedTextureSubImage2D(texture.id(), gl_level, 0, 0, width,
+                                      height, image.compressed_format, size,
+                                      pixels);
+      } else {
+        glTextureSubImage2D(texture.id(), gl_level, 0, 0, width, height,
+                            pixel_format(image.channels), GL_UNSIGNED_BYTE,
+                            pixels);
+      }
+    }
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  if (staging != nullptr) {
+    gl_state().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    in_flight_.push_back({staging_head_ - total_size, staging_head_,
+                          glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+  }
+
+  if (request.target == GL_TEXTURE_2D) {
+    texture.parameter(GL_TEXTURE_WRAP_S, GL_REPEAT);
+    texture.parameter(GL_TEXTURE_WRAP_T, GL_REPEAT);
+    texture.parameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    texture.parameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (generate_mipmaps) {
+      glGenerateTextureMipmap(texture.id());
+    }
+  } else {
+    texture.parameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    texture.parameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    texture.parameter(GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    texture.parameter(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    texture.parameter(GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+  }
+
+  request.memory_size =
+      compressed ? total_size
+                 : total_size / static_cast<std::size_t>(first.channels) *
+                       stored_texel_size(first.channels);
+  if (generate_mipmaps) {
+    request.memory_size += request.memory_size / 3;
+  }
+
+  // Later draws are ordered after the upload, so the texture is usable now
+  request.texture = std::move(texture);
+  request.images.clear();
+  return true;
 }
@@ -1,8 +1,134 @@
 #ifndef TEXTURE_HPP
 #define TEXTURE_HPP
 
+#include "gl_objects.hpp"
+
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
+
+struct TextureRequest;
+
+/**
+ * @brief Refers to a texture that is loaded in the background
+ *
+ * id() is 0 until the texture is uploaded. The GL texture is deleted with the
+ * last handle.
+ */
+class TextureHandle {
+public:
+  TextureHandle() = default;
+
+  [[nodiscard]] bool ready() const noexcept;
+  [[nodiscard]] GLuint id() const noexcept;
+
+  /// Estimated VRAM footprint in bytes, 0 until ready
+  [[nodiscard]] std::size_t memory_size() const noexcept;
+
+private:
+  std::shared_ptr<TextureRequest> request_;
+
+  explicit TextureHandle(std::shared_ptr<TextureRequest> request)
+      : request_{std::move(request)}
+  {
+  }
+
+  friend class TextureLoader;
+  friend class ResourceManager;
+};
+
+/**
+ * @brief Decodes images on worker threads and streams them to the GPU
+ *
+ * Decoded pixels are copied into a persistently mapped pixel unpack buffer
+ * and uploaded from there, so the main thread never waits on decoding and the
+ * driver can DMA the pixels asynchronously. Each region of the staging ring is
+ * reused once the fence of its upload has signaled.
+ */
+class TextureLoader {
+public:
+  explicit TextureLoader(std::size_t staging_size = 64 << 20);
+  ~TextureLoader();
+
+  TextureLoader(const TextureLoader&) = delete;
+  TextureLoader& operator=(const TextureLoader&) = delete;
+  TextureLoader(TextureLoader&&) = delete;
+  TextureLoader& operator=(TextureLoader&&) = delete;
+
+  /// Loads a repeating, mipmapped 2D texture, flipped so that uv (0, 0) is
+  /// the bottom left
+  [[nodiscard]] TextureHandle load_texture(std::string_view path);
+
+  /// Loads a cube map from its +X, -X, +Y, -Y, +Z, -Z faces. The faces are
+  /// decoded in parallel
+  [[nodiscard]] TextureHandle load_cubemap(std::vector<std::string> faces);
+
+  /// Creates a texture from pixels generated at runtime, ready immediately.
+  /// It is clamped to its edges, linearly filtered and has no mipmaps
+  [[nodiscard]] TextureHandle
+  create_texture(GLsizei width, GLsizei height, GLenum internal_format,
+                 GLenum format, GLenum type, const void* pixels,
+                 std::size_t memory_size);
+
+  /// Allocates a 2D array texture whose layers are filled later with
+  /// glTexSubImage3D(). Sampled like create_texture()
+  [[nodiscard]] TextureHandle create_texture_array(GLsizei width,
+                                                   GLsizei height,
+                                                   GLsizei layers,
+                                                   GLenum internal_format,
+                                                   std::size_t memory_size);
+
+  /// Uploads the textures that finished decoding. Call once per frame on the
+  /// thread owning the GL context
+  void update();
+
+  /// Whether every requested texture has been uploaded
+  [[nodiscard]] bool idle() const;
+
+private:
+  struct Job {
+    std::shared_ptr<TextureRequest> request;
+    std::size_t image_index;
+  };
+
+  struct InFlightUpload {
+    std::size_t begin;
+    std::size_t end;
+    GLsync fence;
+  };
+
+  std::vector<std::thread> workers_;
+  mutable std::mutex mutex_;
+  std::condition_variable jobs_available_;
+  std::deque<Job> jobs_;
+  std::vector<std::shared_ptr<TextureRequest>> decoded_;
+  // References of the workers to requests still decoding, released by the GL
+  // thread in case they are the last
+  std::vector<std::shared_ptr<TextureRequest>> released_;
+  std::size_t pending_requests_ = 0;
+  bool stopping_ = false;
+
+  // Only touched by the GL thread
+  std::deque<std::shared_ptr<TextureRequest>> uploads_;
+  Buffer staging_buffer_;
+  unsigned char* staging_memory_ = nullptr;
+  std::size_t staging_size_ = 0;
+  std::size_t staging_head_ = 0;
+  std::deque<InFlightUpload> in_flight_;
 
-unsigned int load_texture(std::string_view s);
+  void submit(std::shared_ptr<TextureRequest> request);
+  void work();
+  void retire_uploads();
+  [[nodiscard]] bool upload(TextureRequest& request);
+  [[nodiscard]] unsigned char* allocate_staging(std::size_t size,
+                                                std::size_t& offset);
+};
 
 #endif // TEXTURE_HPP
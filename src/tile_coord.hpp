@@ -0,0 +1,44 @@
+#ifndef GLGRASSRENDERER_TILE_COORD_HPP
+#define GLGRASSRENDERER_TILE_COORD_HPP
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+
+/// Integer coordinates of a square tile of the world. Tile (x, z) spans
+/// [x, x + 1) * tile_size along x and [z, z + 1) * tile_size along z
+struct TileCoord {
+  int x = 0;
+  int z = 0;
+
+  friend bool operator==(TileCoord, TileCoord) = default;
+};
+
+struct TileCoordHash {
+  [[nodiscard]] std::size_t operator()(TileCoord coord) const noexcept
+  {
+    const auto x = static_cast<std::uint32_t>(coord.x);
+    const auto z = static_cast<std::uint32_t>(coord.z);
+    return std::hash<std::uint64_t>{}(std::uint64_t{x} << 32 | z);
+  }
+};
+
+/// The tile containing `xz`
+[[nodiscard]] inline TileCoord tile_at(glm::vec2 xz, float tile_size) noexcept
+{
+  return {static_cast<int>(std::floor(xz.x / tile_size)),
+          static_cast<int>(std::floor(xz.y / tile_size))};
+}
+
+/// Number of rings of tiles between `a` and `b`
+[[nodiscard]] inline int tile_distance(TileCoord a, TileCoord b) noexcept
+{
+  return std::max(std::abs(a.x - b.x), std::abs(a.z - b.z));
+}
+
+#endif // GLGRASSRENDERER_TILE_COORD_HPP
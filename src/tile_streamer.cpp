@@ -0,0 +1,199 @@
+#include "tile_streamer.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+TileStreamer::TileStreamer(Terrain& terrain, Grasses& grasses)
+    : terrain_{terrain}, grasses_{grasses}
+{
+  worker_ = std::thread{[this] { work(); }};
+}
+
+TileStreamer::~TileStreamer()
+{
+  {
+    std::lock_guard lock{mutex_};
+    stopping_ = true;
+  }
+  jobs_available_.notify_all();
+  worker_.join();
+}
+
+void TileStreamer::work()
+{
+  PROFILE_THREAD("tile streamer");
+  for (;;) {
+    Job job{};
+    {
+      std::unique_lock lock{mutex_};
+      jobs_available_.wait(lock,
+                           [this] { return stopping_ || !jobs_.empty(); });
+      if (stopping_) {
+        return;
+      }
+      job = jobs_.front();
+      jobs_.pop_front();
+    }
+
+    GeneratedTile tile{job, {}, {}};
+    if (job.layer == Layer::Terrain) {
+      tile.heights = Terrain::generate_tile(job.coord);
+    } else {
+      tile.blades = Grasses::generate_tile(job.coord);
+    }
+
+    {
+      std::lock_guard lock{mutex_};
+      generated_.push_back(std::move(tile));
+    }
+    tiles_generated_.notify_one();
+  }
+}
+
+void TileStreamer::update(glm::vec3 camera_position)
+{
+  PROFILE_ZONE("stream_tiles");
+  const TileCoord center =
+      tile_at(glm::vec2(camera_position.x, camera_position.z),
+              Terrain::tile_size);
+  evict(center);
+  upload(center);
+  request(center);
+}
+
+void TileStreamer::flush(glm::vec3 camera_position)
+{
+  for (;;) {
+    update(camera_position);
+    if (requested_terrain_.empty() && requested_grass_.empty()) {
+      return;
+    }
+    std::unique_lock lock{mutex_};
+    tiles_generated_.wait(lock, [this] { return !generated_.empty(); });
+  }
+}
+
+TileStreamer::Stats TileStreamer::stats() const
+{
+  return {resident_terrain_.size(), resident_grass_.size(),
+          requested_terrain_.size() + requested_grass_.size()};
+}
+
+void TileStreamer::evict(TileCoord center)
+{
+  // Grass first: it refers to the heightmap layer of the terrain under it.
+  // Its radius is the smaller one, so no grass outlives its terrain
+  static_assert(Grasses::tile_radius <= Terrain::tile_radius);
+  std::erase_if(resident_grass_, [&](TileCoord coord) {
+    const bool evicted = tile_distance(coord, center) > Grasses::tile_radius;
+    if (evicted) {
+      grasses_.remove_tile(coord);
+    }
+    return evicted;
+  });
+  std::erase_if(resident_terrain_, [&](TileCoord coord) {
+    const bool evicted = tile_distance(coord, center) > Terrain::tile_radius;
+    if (evicted) {
+      terrain_.remove_tile(coord);
+    }
+    return evicted;
+  });
+}
+
+void TileStreamer::upload(TileCoord center)
+{
+  std::deque<GeneratedTile> generated;
+  {
+    std::lock_guard lock{mutex_};
+    generated.swap(generated_);
+  }
+
+  std::size_t uploads = 0;
+  while (!generated.empty() && uploads < max_uploads_per_frame) {
+    GeneratedTile tile = std::move(generated.front());
+    generated.pop_front();
+
+    // Tiles that went out of range while they were generated are dropped
+    const TileCoord coord = tile.job.coord;
+    if (tile.job.layer == Layer::Terrain) {
+      requested_terrain_.erase(coord);
+      if (tile_distance(coord, center) <= Terrain::tile_radius &&
+          terrain_.add_tile(coord, tile.heights)) {
+        resident_terrain_.insert(coord);
+        ++uploads;
+      }
+    } else {
+      requested_grass_.erase(coord);
+      const auto layer = terrain_.layer_of(coord);
+      if (tile_distance(coord, center) <= Grasses::tile_radius &&
+          layer.has_value() &&
+          grasses_.add_tile(coord, *layer, tile.blades)) {
+        resident_grass_.insert(coord);
+        ++uploads;
+      }
+    }
+  }
+
+  // The rest waits for the next frames, ahead of the tiles finished since
+  std::lock_guard lock{mutex_};
+  generated_.insert(generated_.begin(),
+                    std::make_move_iterator(generated.begin()),
+                    std::make_move_iterator(generated.end()));
+}
+
+void TileStreamer::request(TileCoord center)
+{
+  const auto radius_of = [](Layer layer) {
+    return layer == Layer::Terrain ? Terrain::tile_radius
+                                   : Grasses::tile_radius;
+  };
+  const auto requested_of = [this](Layer layer) -> auto& {
+    return layer == Layer::Terrain ? requested_terrain_ : requested_grass_;
+  };
+
+  std::vector<Job> missing;
+  for (int z = -Terrain::tile_radius; z <= Terrain::tile_radius; ++z) {
+    for (int x = -Terrain::tile_radius; x <= Terrain::tile_radius; ++x) {
+      const TileCoord coord{center.x + x, center.z + z};
+      if (!resident_terrain_.contains(coord)) {
+        if (!requested_terrain_.contains(coord)) {
+          missing.push_back({Layer::Terrain, coord});
+        }
+      } else if (tile_distance(coord, center) <= Grasses::tile_radius &&
+                 !resident_grass_.contains(coord) &&
+                 !requested_grass_.contains(coord)) {
+        missing.push_back({Layer::Grass, coord});
+      }
+    }
+  }
+
+  {
+    std::lock_guard lock{mutex_};
+    // Jobs that went out of range before the worker got to them are
+    // cancelled
+    std::erase_if(jobs_, [&](const Job& job) {
+      const bool cancelled =
+          tile_distance(job.coord, center) > radius_of(job.layer);
+      if (cancelled) {
+        requested_of(job.layer).erase(job.coord);
+      }
+      return cancelled;
+    });
+    if (missing.empty()) {
+      return;
+    }
+
+    for (const Job& job : missing) {
+      requested_of(job.layer).insert(job.coord);
+      jobs_.push_back(job);
+    }
+    // Nearest first
+    std::stable_sort(jobs_.begin(), jobs_.end(),
+                     [&](const Job& a, const Job& b) {
+                       return tile_distance(a.coord, center) <
+                              tile_distance(b.coord, center);
+                     });
+  }
+  jobs_available_.notify_one();
+}
@@ -0,0 +1,100 @@
+#ifndef GLGRASSRENDERER_TILE_STREAMER_HPP
+#define GLGRASSRENDERER_TILE_STREAMER_HPP
+
+#include "gpu_types.hpp"
+#include "grasses.hpp"
+#include "terrain.hpp"
+#include "tile_coord.hpp"
+
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Keeps the terrain and grass tiles around the camera resident
+ *
+ * Tiles are generated on a worker thread, nearest first, and uploaded on the
+ * GL thread a few per frame so that crossing a tile border never stalls a
+ * frame. Tiles that fall out of range are evicted, which frees their slot
+ * for the tiles coming into range: the memory held by the world is bounded
+ * by the radii, not by the distance travelled.
+ *
+ * A grass tile is only generated once the terrain tile under it is
+ * resident, and is evicted before it.
+ */
+class TileStreamer {
+public:
+  /// Tiles uploaded per frame at most
+  static constexpr std::size_t max_uploads_per_frame = 4;
+
+  struct Stats {
+    std::size_t terrain_tiles = 0;
+    std::size_t grass_tiles = 0;
+    /// Tiles being generated or waiting for their upload
+    std::size_t pending_tiles = 0;
+  };
+
+  /// `terrain` and `grasses` must outlive the streamer
+  TileStreamer(Terrain& terrain, Grasses& grasses);
+  ~TileStreamer();
+
+  TileStreamer(const TileStreamer&) = delete;
+  TileStreamer& operator=(const TileStreamer&) = delete;
+  TileStreamer(TileStreamer&&) = delete;
+  TileStreamer& operator=(TileStreamer&&) = delete;
+
+  /// Evicts the tiles out of range of `camera_position`, uploads the tiles
+  /// that finished generating and requests the missing ones. Call once per
+  /// frame on the thread owning the GL context
+  void update(glm::vec3 camera_position);
+
+  /// Like update(), but returns once every tile in range of
+  /// `camera_position` is resident, regardless of the per-frame budget
+  void flush(glm::vec3 camera_position);
+
+  [[nodiscard]] Stats stats() const;
+
+private:
+  enum class Layer { Terrain, Grass };
+
+  struct Job {
+    Layer layer;
+    TileCoord coord;
+  };
+
+  struct GeneratedTile {
+    Job job;
+    std::vector<float> heights;
+    std::vector<Blade> blades;
+  };
+
+  Terrain& terrain_;
+  Grasses& grasses_;
+
+  std::thread worker_;
+  mutable std::mutex mutex_;
+  std::condition_variable jobs_available_;
+  std::condition_variable tiles_generated_;
+  std::deque<Job> jobs_;
+  std::deque<GeneratedTile> generated_;
+  bool stopping_ = false;
+
+  // Only touched by the GL thread
+  std::unordered_set<TileCoord, TileCoordHash> resident_terrain_;
+  std::unordered_set<TileCoord, TileCoordHash> resident_grass_;
+  // Tiles queued, being generated or waiting for their upload
+  std::unordered_set<TileCoord, TileCoordHash> requested_terrain_;
+  std::unordered_set<TileCoord, TileCoordHash> requested_grass_;
+
+  void work();
+  void evict(TileCoord center);
+  void upload(TileCoord center);
+  void request(TileCoord center);
+};
+
+#endif // GLGRASSRENDERER_TILE_STREAMER_HPP
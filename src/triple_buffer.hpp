@@ -0,0 +1,71 @@
+#ifndef GLGRASSRENDERER_TRIPLE_BUFFER_HPP
+#define GLGRASSRENDERER_TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+
+/**
+ * @brief Hands the latest value from one writer thread to one reader thread
+ * without locks
+ *
+ * The writer fills its own slot and publishes it by swapping it with the
+ * middle slot, and the reader swaps the middle slot with its own when a
+ * newer value is there. Neither ever waits for the other: the writer may
+ * publish many values between two reads, and the reader then only sees the
+ * last one.
+ */
+template <typename T> class TripleBuffer {
+public:
+  TripleBuffer() = default;
+  explicit TripleBuffer(const T& initial)
+      : slots_{Slot{initial}, Slot{initial}, Slot{initial}}
+  {
+  }
+
+  /// Writer only: the slot to fill before publish()
+  [[nodiscard]] T& back() noexcept
+  {
+    return slots_[back_].value;
+  }
+
+  /// Writer only: makes back() the latest value, and hands out a new back()
+  void publish() noexcept
+  {
+    back_ = middle_.exchange(back_ | fresh, std::memory_order_acq_rel) &
+            index_mask;
+  }
+
+  void write(const T& value)
+  {
+    back() = value;
+    publish();
+  }
+
+  /// Reader only: the latest value published, which stays valid until the
+  /// next call. The initial value until the first publish()
+  [[nodiscard]] const T& read() noexcept
+  {
+    if ((middle_.load(std::memory_order_relaxed) & fresh) != 0) {
+      front_ = middle_.exchange(front_, std::memory_order_acq_rel) &
+               index_mask;
+    }
+    return slots_[front_].value;
+  }
+
+private:
+  static constexpr unsigned index_mask = 3;
+  /// Set in middle_ when it holds a value the reader has not seen
+  static constexpr unsigned fresh = 4;
+
+  // Apart, so that the threads do not share cache lines
+  struct alignas(64) Slot {
+    T value;
+  };
+
+  std::array<Slot, 3> slots_{};
+  alignas(64) unsigned back_ = 0;
+  alignas(64) std::atomic<unsigned> middle_{1};
+  alignas(64) unsigned front_ = 2;
+};
+
+#endif // GLGRASSRENDERER_TRIPLE_BUFFER_HPP
@@ -0,0 +1,57 @@
+#include "upload_ring.hpp"
+#include "gl_extensions.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr GLbitfield mapping_flags =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+[[nodiscard]] std::size_t uniform_buffer_offset_alignment()
+{
+  GLint alignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  return static_cast<std::size_t>(std::max(alignment, 1));
+}
+
+} // anonymous namespace
+
+// Every region starts aligned, so that its first allocation can be bound
+UploadRing::UploadRing(std::size_t frames_in_flight, std::size_t frame_size)
+    : alignment_{uniform_buffer_offset_alignment()},
+      frame_size_{(frame_size + alignment_ - 1) / alignment_ * alignment_},
+      buffer_{static_cast<GLsizeiptr>(frame_size_ * frames_in_flight),
+              nullptr, mapping_flags}
+{
+  memory_ = static_cast<unsigned char*>(
+      glMapNamedBufferRange(buffer_.id(), 0, buffer_.size(), mapping_flags));
+}
+
+UploadRing::~UploadRing()
+{
+  glUnmapNamedBuffer(buffer_.id());
+}
+
+void UploadRing::begin_frame(std::size_t slot)
+{
+  frame_ = slot;
+  head_ = 0;
+}
+
+UploadRing::Allocation UploadRing::upload(const void* data, std::size_t size)
+{
+  if (head_ + size > frame_size_) {
+    throw std::runtime_error{fmt::format(
+        "Per-frame uploads exceed the {} bytes of a frame", frame_size_)};
+  }
+
+  const std::size_t offset = frame_ * frame_size_ + head_;
+  std::memcpy(memory_ + offset, data, size);
+  head_ = (head_ + size + alignment_ - 1) / alignment_ * alignment_;
+  return {static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size)};
+}
@@ -0,0 +1,66 @@
+#ifndef GLGRASSRENDERER_UPLOAD_RING_HPP
+#define GLGRASSRENDERER_UPLOAD_RING_HPP
+
+#include "gl_objects.hpp"
+#include "gl_state.hpp"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+/**
+ * @brief Allocates the per-frame constants of the renderer from a ring of
+ * frame regions
+ *
+ * The buffer is persistently mapped and split into one region per frame in
+ * flight. Each frame writes its constants into the region of its FramePacer
+ * slot with a memcpy and binds them with glBindBufferRange(), so no upload
+ * ever waits on a draw still reading the previous values. The pacer has
+ * waited for the GPU to release the region by the time its slot comes back.
+ */
+class UploadRing {
+public:
+  struct Allocation {
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+  };
+
+  explicit UploadRing(std::size_t frames_in_flight,
+                      std::size_t frame_size = 64 << 10);
+  ~UploadRing();
+
+  UploadRing(const UploadRing&) = delete;
+  UploadRing& operator=(const UploadRing&) = delete;
+  UploadRing(UploadRing&&) = delete;
+  UploadRing& operator=(UploadRing&&) = delete;
+
+  /// Starts writing the region of frame slot `slot`
+  void begin_frame(std::size_t slot);
+
+  /// Copies `size` bytes into the region of the frame. Throws
+  /// std::runtime_error when the region is full
+  [[nodiscard]] Allocation upload(const void* data, std::size_t size);
+
+  template <typename T> [[nodiscard]] Allocation upload(const T& value)
+  {
+    return upload(&value, sizeof(value));
+  }
+
+  /// Uploads `value` and binds it to the uniform block `binding`
+  template <typename T> void bind_uniforms(GLuint binding, const T& value)
+  {
+    const Allocation allocation = upload(value);
+    gl_state().bind_buffer_range(GL_UNIFORM_BUFFER, binding, buffer_.id(),
+                                 allocation.offset, allocation.size);
+  }
+
+private:
+  std::size_t alignment_ = 0;
+  std::size_t frame_size_ = 0;
+  Buffer buffer_;
+  unsigned char* memory_ = nullptr;
+  std::size_t frame_ = 0;
+  std::size_t head_ = 0;
+};
+
+#endif // GLGRASSRENDERER_UPLOAD_RING_HPP
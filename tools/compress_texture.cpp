@@ -0,0 +1,136 @@
+// Converts an image into a BC1-compressed KTX2 file with a full mip chain,
+// which the app loads instead of the image it was made from.
+//
+//   compress_texture [--flip] <input> <output>
+//
+// --flip stores the image bottom row first, which is how 2D textures are
+// sampled. Cube map faces are stored top row first.
+
+#include "bc1.hpp"
+#include "ktx2.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Image {
+  std::vector<unsigned char> pixels;
+  std::size_t width;
+  std::size_t height;
+  std::size_t channels;
+};
+
+[[nodiscard]] Image load_image(const std::string& path, bool flip)
+{
+  stbi_set_flip_vertically_on_load(flip);
+  int width = 0;
+  int height = 0;
+  int channels = 0;
+  const std::unique_ptr<unsigned char, decltype(&stbi_image_free)> data{
+      stbi_load(path.c_str(), &width, &height, &channels, 0), stbi_image_free};
+  if (data == nullptr) {
+    throw std::runtime_error{
+        fmt::format("Cannot load {}: {}", path, stbi_failure_reason())};
+  }
+
+  const auto size = static_cast<std::size_t>(width) *
+                    static_cast<std::size_t>(height) *
+                    static_cast<std::size_t>(channels);
+  return {{data.get(), data.get() + size},
+          static_cast<std::size_t>(width),
+          static_cast<std::size_t>(height),
+          static_cast<std::size_t>(channels)};
+}
+
+/// Halves each dimension with a box filter, like glGenerateMipmap does
+[[nodiscard]] Image downsample(const Image& image)
+{
+  Image result{{},
+               std::max<std::size_t>(image.width / 2, 1),
+               std::max<std::size_t>(image.height / 2, 1),
+               image.channels};
+  result.pixels.resize(result.width * result.height * result.channels);
+
+  const auto texel = [&](std::size_t x, std::size_t y, std::size_t channel) {
+    x = std::min(x, image.width - 1);
+    y = std::min(y, image.height - 1);
+    return unsigned{image.pixels[(y * image.width + x) * image.channels +
+                                 channel]};
+  };
+  for (std::size_t y = 0; y < result.height; ++y) {
+    for (std::size_t x = 0; x < result.width; ++x) {
+      for (std::size_t c = 0; c < image.channels; ++c) {
+        const auto sum = texel(2 * x, 2 * y, c) + texel(2 * x + 1, 2 * y, c) +
+                         texel(2 * x, 2 * y + 1, c) +
+                         texel(2 * x + 1, 2 * y + 1, c);
+        result.pixels[(y * result.width + x) * image.channels + c] =
+            static_cast<unsigned char>((sum + 2) / 4);
+      }
+    }
+  }
+  return result;
+}
+
+void write_file(const std::string& path, const std::vector<unsigned char>& data)
+{
+  std::ofstream out{path, std::ios::binary};
+  out.write(reinterpret_cast<const char*>(data.data()),
+            static_cast<std::streamsize>(data.size()));
+  if (!out) {
+    throw std::runtime_error{fmt::format("Failed to write {}", path)};
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+try {
+  std::vector<std::string> args(argv + 1, argv + argc);
+  bool flip = false;
+  if (!args.empty() && args.front() == "--flip") {
+    flip = true;
+    args.erase(args.begin());
+  }
+  if (args.size() != 2) {
+    fmt::print(stderr, "Usage: compress_texture [--flip] <input> <output>\n");
+    return 1;
+  }
+
+  auto image = load_image(args[0], flip);
+
+  Ktx2Texture texture;
+  texture.vk_format = vk_format_bc1_rgb_unorm_block;
+  texture.width = static_cast<std::uint32_t>(image.width);
+  texture.height = static_cast<std::uint32_t>(image.height);
+
+  std::vector<std::vector<unsigned char>> levels;
+  for (;;) {
+    levels.push_back(
+        bc1_compress(image.pixels, image.width, image.height, image.channels));
+    if (image.width == 1 && image.height == 1) {
+      break;
+    }
+    image = downsample(image);
+  }
+  for (const auto& level : levels) {
+    texture.levels.emplace_back(level);
+  }
+
+  const auto file = write_ktx2(texture);
+  write_file(args[1], file);
+  fmt::print("Compressed {} to {} bytes in {} levels\n", args[0], file.size(),
+             levels.size());
+} catch (const std::exception& e) {
+  fmt::print(stderr, "Error: {}\n", e.what());
+  return 1;
+}
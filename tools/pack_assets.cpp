@@ -0,0 +1,190 @@
+// Packs data directories into a single indexed archive read by AssetPack.
+//
+//   pack_assets [--no-compression] <data_dir>... <output>
+//
+// Entries are named by their path relative to their data directory, so
+// files generated at build time can be packed alongside the sources.
+//
+// Entries are LZ4-compressed when that saves at least an eighth of their
+// size, so already-compressed formats such as JPEG are stored as they are.
+
+#include "asset_pack_format.hpp"
+#include "lz4_block.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct InputFile {
+  std::string name;
+  std::vector<unsigned char> stored;
+  std::uint64_t size;
+  PackCompression compression;
+};
+
+[[nodiscard]] std::vector<unsigned char> read_file(const fs::path& path)
+{
+  std::ifstream file{path, std::ios::binary};
+  if (!file.is_open()) {
+    throw std::runtime_error{
+        fmt::format("Cannot open file {}", path.string())};
+  }
+  return {std::istreambuf_iterator<char>{file},
+          std::istreambuf_iterator<char>{}};
+}
+
+void collect(const fs::path& data_dir, bool compress,
+             std::vector<InputFile>& files)
+{
+  for (const auto& dir_entry : fs::recursive_directory_iterator{data_dir}) {
+    // Skip the helper sources that live next to the assets
+    if (!dir_entry.is_regular_file() ||
+        dir_entry.path().extension() == ".cpp") {
+      continue;
+    }
+
+    InputFile file;
+    file.name = dir_entry.path().lexically_relative(data_dir).generic_string();
+    file.stored = read_file(dir_entry.path());
+    file.size = file.stored.size();
+    file.compression = PackCompression::none;
+
+    if (compress) {
+      auto compressed = lz4_compress(file.stored);
+      if (compressed.size() < file.stored.size() - file.stored.size() / 8) {
+        file.stored = std::move(compressed);
+        file.compression = PackCompression::lz4;
+      }
+    }
+    files.push_back(std::move(file));
+  }
+}
+
+void sort_by_name(std::vector<InputFile>& files)
+{
+  std::sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.name < rhs.name;
+  });
+  const auto duplicate = std::adjacent_find(
+      files.begin(), files.end(),
+      [](const auto& lhs, const auto& rhs) { return lhs.name == rhs.name; });
+  if (duplicate != files.end()) {
+    throw std::runtime_error{
+        fmt::format("{} is in more than one data directory", duplicate->name)};
+  }
+}
+
+[[nodiscard]] std::uint64_t align(std::uint64_t offset)
+{
+  return (offset + pack_alignment - 1) / pack_alignment * pack_alignment;
+}
+
+void write_pack(const std::vector<InputFile>& files, const fs::path& output)
+{
+  std::string names;
+  for (const auto& file : files) {
+    names += file.name;
+  }
+
+  PackHeader header{};
+  std::memcpy(header.magic, pack_magic, sizeof(pack_magic));
+  header.version = pack_version;
+  header.entry_count = static_cast<std::uint32_t>(files.size());
+  header.names_size = static_cast<std::uint32_t>(names.size());
+
+  std::vector<PackEntry> entries;
+  std::uint64_t offset = align(sizeof(PackHeader) +
+                               files.size() * sizeof(PackEntry) + names.size());
+  std::uint32_t name_offset = 0;
+  for (const auto& file : files) {
+    PackEntry entry{};
+    entry.offset = offset;
+    entry.stored_size = file.stored.size();
+    entry.size = file.size;
+    entry.name_offset = name_offset;
+    entry.name_length = static_cast<std::uint32_t>(file.name.size());
+    entry.compression = file.compression;
+    entries.push_back(entry);
+
+    offset = align(offset + file.stored.size());
+    name_offset += entry.name_length;
+  }
+
+  std::ofstream out{output, std::ios::binary};
+  if (!out.is_open()) {
+    throw std::runtime_error{
+        fmt::format("Cannot write file {}", output.string())};
+  }
+  const auto write = [&](const void* data, std::size_t size) {
+    out.write(static_cast<const char*>(data),
+              static_cast<std::streamsize>(size));
+  };
+  const auto pad = [&] {
+    static constexpr char zeros[pack_alignment] = {};
+    const auto position = static_cast<std::uint64_t>(out.tellp());
+    write(zeros, align(position) - position);
+  };
+
+  write(&header, sizeof(header));
+  write(entries.data(), entries.size() * sizeof(PackEntry));
+  write(names.data(), names.size());
+  for (const auto& file : files) {
+    pad();
+    write(file.stored.data(), file.stored.size());
+  }
+
+  if (!out) {
+    throw std::runtime_error{
+        fmt::format("Failed to write {}", output.string())};
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+try {
+  std::vector<std::string> args(argv + 1, argv + argc);
+  bool compress = true;
+  if (!args.empty() && args.front() == "--no-compression") {
+    compress = false;
+    args.erase(args.begin());
+  }
+  if (args.size() < 2) {
+    fmt::print(
+        stderr,
+        "Usage: pack_assets [--no-compression] <data_dir>... <output>\n");
+    return 1;
+  }
+
+  const auto output = args.back();
+  args.pop_back();
+  std::vector<InputFile> files;
+  for (const auto& data_dir : args) {
+    collect(data_dir, compress, files);
+  }
+  sort_by_name(files);
+  write_pack(files, output);
+
+  std::uint64_t size = 0;
+  std::uint64_t stored_size = 0;
+  for (const auto& file : files) {
+    size += file.size;
+    stored_size += file.stored.size();
+  }
+  fmt::print("Packed {} assets, {} bytes stored as {}\n", files.size(), size,
+             stored_size);
+} catch (const std::exception& e) {
+  fmt::print(stderr, "Error: {}\n", e.what());
+  return 1;
+}
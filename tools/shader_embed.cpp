@@ -0,0 +1,124 @@
+// Build-time helper for the app's shaders.
+//
+//   shader_embed preprocess <data_dir> <shader> <output> [NAME=VALUE...]
+//     Expands the #include directives of <shader> so that it can be validated
+//     by glslangValidator, which does not understand our includes. The
+//     defines select a permutation, as ShaderBuilder::define() does.
+//
+//   shader_embed embed <data_dir> <output.cpp> <shaders...>
+//     Generates the embedded_shaders() table with the raw sources of
+//     <shaders>. Includes are embedded as they are and resolved at runtime.
+
+#include "shader_preprocessor.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+[[nodiscard]] std::string read_file(const std::string& path)
+{
+  std::ifstream file{path, std::ios::binary};
+  if (!file.is_open()) {
+    throw std::runtime_error{fmt::format("Cannot open file {}", path)};
+  }
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+void write_file(const std::string& path, const std::string& content)
+{
+  std::ofstream file{path, std::ios::binary};
+  if (!file.is_open()) {
+    throw std::runtime_error{fmt::format("Cannot write file {}", path)};
+  }
+  file << content;
+}
+
+void preprocess(const std::string& data_dir, const std::string& shader,
+                const std::string& output,
+                const std::vector<std::string>& define_args)
+{
+  std::map<std::string, std::string> defines;
+  for (const auto& define : define_args) {
+    const auto equals = define.find('=');
+    if (equals == std::string::npos) {
+      defines.insert_or_assign(define, std::string{});
+    } else {
+      defines.insert_or_assign(define.substr(0, equals),
+                               define.substr(equals + 1));
+    }
+  }
+
+  const auto preprocessed =
+      preprocess_shader(shader, defines, [&](const std::string& filename) {
+        return read_file(data_dir + "/" + filename);
+      });
+  write_file(output, preprocessed.source);
+}
+
+void embed(const std::string& data_dir, const std::string& output,
+           const std::vector<std::string>& shaders)
+{
+  std::string generated = "// Generated by shader_embed, do not edit\n"
+                          "#include \"embedded_shaders.hpp\"\n\n"
+                          "namespace {\n\n";
+
+  for (std::size_t i = 0; i < shaders.size(); ++i) {
+    const auto source = read_file(data_dir + "/" + shaders[i]);
+
+    // Byte arrays rather than string literals, which MSVC limits in length
+    generated +=
+        fmt::format("// {}\nconstexpr char source_{}[] = {{", shaders[i], i);
+    for (std::size_t j = 0; j < source.size(); ++j) {
+      generated += fmt::format(
+          "{}'\\x{:02x}',", j % 12 == 0 ? "\n    " : " ",
+          static_cast<unsigned int>(static_cast<unsigned char>(source[j])));
+    }
+    generated += "\n    '\\0'};\n\n";
+  }
+
+  generated += "constexpr EmbeddedShader shaders[] = {\n";
+  for (std::size_t i = 0; i < shaders.size(); ++i) {
+    generated += fmt::format(
+        "    {{\"{}\", {{source_{}, sizeof(source_{}) - 1}}}},\n", shaders[i],
+        i, i);
+  }
+  generated += "};\n\n"
+               "} // anonymous namespace\n\n"
+               "std::span<const EmbeddedShader> embedded_shaders() noexcept\n"
+               "{\n"
+               "  return shaders;\n"
+               "}\n";
+
+  write_file(output, generated);
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+try {
+  const std::vector<std::string> args(argv + 1, argv + argc);
+  if (args.size() >= 4 && args[0] == "preprocess") {
+    preprocess(args[1], args[2], args[3], {args.begin() + 4, args.end()});
+  } else if (args.size() >= 3 && args[0] == "embed") {
+    embed(args[1], args[2], {args.begin() + 3, args.end()});
+  } else {
+    fmt::print(stderr,
+               "Usage: shader_embed preprocess <data_dir> <shader> <output> "
+               "[NAME=VALUE...]\n"
+               "       shader_embed embed <data_dir> <output> <shaders...>\n");
+    return 1;
+  }
+} catch (const std::exception& e) {
+  fmt::print(stderr, "Error: {}\n", e.what());
+  return 1;
+}